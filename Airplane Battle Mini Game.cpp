@@ -1,6 +1,22 @@
 #include "raylib.h"
 #include <stdlib.h>
+#include <stdio.h>
 #include <math.h>
+#include <time.h>
+#include <string.h>
+#include <chrono>
+
+#include "telemetry.h"
+#include "profile.h"
+#include "director.h"
+#include "behaviour.h"
+#include "input.h"
+#include "asset_archive.h"
+#include "starfield.h"
+#include "capture.h"
+#include "audio.h"
+#include "kdtree.h"
+#include "perf_counters.h"
 
 #define MAX_BULLETS 200
 #define MAX_ENEMIES 15
@@ -10,6 +26,23 @@
 #define MAX_BOMBS 3
 #define BOMB_RADIUS 300.0f
 #define BOMB_DURATION 0.5f
+#define MISSILE_SPEED 9.0f
+#define MISSILE_TURN_RATE 0.25f		// share of the desired heading blended in per tick
+#define MISSILE_LIFETIME 2.5f
+#define TARGET_FPS 60
+#define LOW_LATENCY_MARGIN 0.002
+#define BENCH_TICKS 36000
+#define BENCH_SEED 1
+#define BENCH_TELEMETRY_FILE "telemetry_bench.bin"
+#define BENCH_TELEMETRY_RECORDS 1000000
+#define BENCH_SFX_STORM 8		// extra shot sounds requested per tick, a bullet-hell worth
+#define BENCH_TARGET_QUERIES 512	// homing missiles retargeting per tick
+#define BENCH_TARGET_ROUNDS 200
+#define BENCH_PHASE_TICKS 3000		// per fixed workload
+#define SPRITE_ANIMATION_FPS 8.0f
+
+static_assert(BEHAVIOUR_ARENA_BLOCKS >= MAX_ENEMIES, "every enemy needs room for a behaviour frame");
+static_assert(KD_MAX_POINTS >= MAX_ENEMIES, "the target tree must hold every enemy");
 
 typedef enum {
 	MENU,
@@ -28,9 +61,17 @@ typedef enum {
 typedef enum {
 	SHOTGUN_POWERUP,
 	HEALTH_POWERUP,
-	BOMB_POWERUP
+	BOMB_POWERUP,
+	HOMING_POWERUP
 } PowerUpType;
 
+typedef enum {
+	SIM_PHASE_BULLETS,
+	SIM_PHASE_ENEMIES,
+	SIM_PHASE_COLLISIONS,
+	SIM_PHASE_COUNT
+} SimPhase;
+
 typedef enum {
 	NORMAL_ENEMY,
 	ELITE_ENEMY,
@@ -44,6 +85,10 @@ typedef struct {
 	bool active;
 	Color color;
 	bool isPlayerBullet;
+	EnemyType owner;
+	bool homing;
+	float life;			// seconds left, homing missiles only
+	int damage;			// to the player, enemy bullets only
 } Bullet;
 
 typedef struct {
@@ -55,8 +100,7 @@ typedef struct {
 	int health;
 	int maxHealth;
 	EnemyType type;
-	float shootTimer;
-	float shootInterval;
+	BehaviourState behaviour;
 	int scoreValue;
 } Enemy;
 
@@ -77,6 +121,8 @@ typedef struct {
 	Color color;
 	bool hasShotgun;
 	float shotgunTimer;
+	bool hasHoming;
+	float homingTimer;
 	int health;
 	int maxHealth;
 	int bombCount;
@@ -92,8 +138,7 @@ typedef struct {
 } BombEffect;
 
 typedef struct {
-	int timedModeHighScore;
-	int infiniteModeHighScore;
+	Leaderboard boards[PROFILE_MODE_COUNT];
 } HighScores;
 
 typedef struct {
@@ -102,6 +147,30 @@ typedef struct {
 	int gamesPlayed;
 } Achievements;
 
+static void LoadProgress(HighScores *highScores, Achievements *achievements) {
+	ProfileData profile;
+	LoadProfile(&profile);
+	
+	for (int mode = 0; mode < PROFILE_MODE_COUNT; mode++) {
+		highScores->boards[mode] = profile.leaderboards[mode];
+	}
+	achievements->gamesPlayed = profile.gamesPlayed;
+	achievements->pilotAchieved = profile.pilotAchieved;
+	achievements->hobbyistAchieved = profile.hobbyistAchieved;
+}
+
+static void SaveProgress(ProfileSaver *saver, const HighScores *highScores, const Achievements *achievements) {
+	ProfileData profile = {0};
+	for (int mode = 0; mode < PROFILE_MODE_COUNT; mode++) {
+		profile.leaderboards[mode] = highScores->boards[mode];
+	}
+	profile.gamesPlayed = achievements->gamesPlayed;
+	profile.pilotAchieved = achievements->pilotAchieved;
+	profile.hobbyistAchieved = achievements->hobbyistAchieved;
+	
+	ProfileSaveAsync(saver, &profile);
+}
+
 void DrawInstructionsScreen(int screenWidth, int screenHeight) {
 	ClearBackground(BLACK);
 	
@@ -131,9 +200,10 @@ void DrawInstructionsScreen(int screenWidth, int screenHeight) {
 	
 	// Powerups
 	DrawText("POWERUPS:", screenWidth/2 + 50, 120, 30, WHITE);
-	DrawText("- GREEN (S): Shotgun power (triple shot)", screenWidth/2 + 70, 160, 25, WHITE);
-	DrawText("- BLUE (H): Health power (restore health)", screenWidth/2 + 70, 190, 25, WHITE);
-	DrawText("- RED (B): Bomb power (+1 bomb)", screenWidth/2 + 70, 220, 25, WHITE);
+	DrawText("- GREEN (S): Shotgun power (triple shot)", screenWidth/2 + 70, 155, 25, WHITE);
+	DrawText("- BLUE (H): Health power (restore health)", screenWidth/2 + 70, 183, 25, WHITE);
+	DrawText("- RED (B): Bomb power (+1 bomb)", screenWidth/2 + 70, 211, 25, WHITE);
+	DrawText("- PINK (M): Homing missiles", screenWidth/2 + 70, 239, 25, WHITE);
 	
 	// Bomb System
 	DrawText("BOMB SYSTEM:", screenWidth/2 + 50, 270, 30, WHITE);
@@ -154,586 +224,845 @@ void DrawInstructionsScreen(int screenWidth, int screenHeight) {
 			 screenHeight - 60, 25, WHITE);
 }
 
-int main(void) {
-	const int screenWidth = 1280;
-	const int screenHeight = 768;
+static const int screenWidth = 1280;
+static const int screenHeight = 768;
+
+static TelemetryWriter telemetry;
+static SpawnDirector director;
+
+static InputQueue input;
+static LatencyStats inputLatency;
+static bool lowLatencyPacing = false;
+
+static AssetArchive assets;
+static Starfield starfield;
+static CaptureState capture;
+static AudioMixer audio;
+static float startupMs = 0.0f;		// process start to first presented menu frame
+
+static bool showProfiler = false;
+static float frameSimMs = 0.0f;
+static float frameDrawMs = 0.0f;
+
+static GameState gameState = MENU;
+static GameMode gameMode = TIMED_MODE;
+
+static Player player = {
+	.position = { screenWidth/2, screenHeight - 50 },
+	.speed = { 10, 10 },
+	.radius = 25,
+	.color = BLUE,
+	.hasShotgun = false,
+	.shotgunTimer = 0.0f,
+	.hasHoming = false,
+	.homingTimer = 0.0f,
+	.health = 3,
+	.maxHealth = 5,
+	.bombCount = 0,
+	.maxBombs = MAX_BOMBS,
+	.bombDamage = 5
+};
+
+static Bullet bullets[MAX_BULLETS] = {0};
+static Enemy enemies[MAX_ENEMIES] = {0};
+static PowerUp powerups[MAX_POWERUPS] = {0};
+static BombEffect bombEffect = {0};
+static KdTree targetTree;
+
+// Only measured by the benchmark; idle until OpenPerfCounters()
+static PerfCounters perfCounters;
+static PerfPhase simPhases[SIM_PHASE_COUNT] = { { "bullets" }, { "enemies" }, { "collisions" } };
+
+static int score = 0;
+static int level = 1;
+static float enemySpawnTimer = 0;
+static float enemySpawnInterval = 1.5f;
+static float powerupSpawnTimer = 0;
+static float powerupSpawnInterval = 10.0f;
+static float eliteSpawnTimer = 0;
+static float eliteSpawnInterval = 15.0f;
+static float bossSpawnTimer = 0;
+static float bossSpawnInterval = 30.0f;
+
+static float gameTime = 60.0f;
+static float timeElapsed = 0.0f;
+static float minuteTimer = 0.0f;
+
+static HighScores highScores = {0};
+static Achievements achievements = {0};
+
+static ProfileSaver profileSaver;
+static int leaderboardRank = -1;
+
+static bool bossAlive = false;
+static float bossFightTime = 0.0f;
+static const Rectangle bossArea = { 
+	screenWidth * 0.2f, 
+	screenHeight * 0.1f, 
+	screenWidth * 0.6f, 
+	screenHeight * 0.6f 
+};
+
+// Resets the playfield for a new run in the current gameMode.
+static void StartGame(void) {
+	score = 0;
+	ResetDirector(&director);
+	level = 1;
+	player.health = 3;
+	player.maxHealth = 5;
+	gameTime = 60.0f;
+	timeElapsed = 0.0f;
+	minuteTimer = 0.0f;
+	player.hasShotgun = false;
+	player.shotgunTimer = 0.0f;
+	player.hasHoming = false;
+	player.homingTimer = 0.0f;
+	player.bombCount = 0;
+	player.maxBombs = MAX_BOMBS;
+	player.bombDamage = 5;
+	bossAlive = false;
+	bombEffect.active = false;
 	
-	InitWindow(screenWidth, screenHeight, "Plane Shooter Game");
-	SetTargetFPS(60);
-	
-	GameState gameState = MENU;
-	GameMode gameMode = TIMED_MODE;
-	
-	Player player = {
-		.position = { screenWidth/2, screenHeight - 50 },
-		.speed = { 10, 10 },
-		.radius = 25,
-		.color = BLUE,
-		.hasShotgun = false,
-		.shotgunTimer = 0.0f,
-		.health = 3,
-		.maxHealth = 5,
-		.bombCount = 0,
-		.maxBombs = MAX_BOMBS,
-		.bombDamage = 5
-	};
+	for (int i = 0; i < MAX_ENEMIES; i++) {
+		enemies[i].active = false;
+	}
 	
-	Bullet bullets[MAX_BULLETS] = {0};
-	Enemy enemies[MAX_ENEMIES] = {0};
-	PowerUp powerups[MAX_POWERUPS] = {0};
-	BombEffect bombEffect = {0};
-	
-	int score = 0;
-	int level = 1;
-	float enemySpawnTimer = 0;
-	float enemySpawnInterval = 1.5f;
-	float powerupSpawnTimer = 0;
-	float powerupSpawnInterval = 10.0f;
-	float eliteSpawnTimer = 0;
-	float eliteSpawnInterval = 15.0f;
-	float bossSpawnTimer = 0;
-	float bossSpawnInterval = 30.0f;
-	
-	float gameTime = 60.0f;
-	float timeElapsed = 0.0f;
-	float minuteTimer = 0.0f;
-	
-	HighScores highScores = {0};
-	Achievements achievements = {0};
-	
-	bool bossAlive = false;
-	const Rectangle bossArea = { 
-		screenWidth * 0.2f, 
-		screenHeight * 0.1f, 
-		screenWidth * 0.6f, 
-		screenHeight * 0.6f 
-	};
+	for (int i = 0; i < MAX_BULLETS; i++) {
+		bullets[i].active = false;
+	}
 	
-	while (!WindowShouldClose()) {
-		switch (gameState) {
-		case MENU:
-			if (IsKeyPressed(KEY_ENTER)) {
-				gameState = PLAYING;
-				achievements.gamesPlayed++;
-				
-				if (achievements.gamesPlayed >= 10 && !achievements.hobbyistAchieved) {
-					achievements.hobbyistAchieved = true;
-				}
-				
-				score = 0;
-				level = 1;
-				player.health = 3;
-				player.maxHealth = 5;
-				gameTime = 60.0f;
-				timeElapsed = 0.0f;
-				minuteTimer = 0.0f;
-				player.hasShotgun = false;
-				player.shotgunTimer = 0.0f;
-				player.bombCount = 0;
-				player.maxBombs = MAX_BOMBS;
-				player.bombDamage = 5;
-				bossAlive = false;
-				bombEffect.active = false;
-				
-				for (int i = 0; i < MAX_ENEMIES; i++) {
-					enemies[i].active = false;
-				}
-				
-				for (int i = 0; i < MAX_BULLETS; i++) {
-					bullets[i].active = false;
-				}
-				
-				for (int i = 0; i < MAX_POWERUPS; i++) {
-					powerups[i].active = false;
+	for (int i = 0; i < MAX_POWERUPS; i++) {
+		powerups[i].active = false;
+	}
+	
+	player.position = (Vector2){ screenWidth/2, screenHeight - 50 };
+}
+
+static void FirePlayerShot(void) {
+	if (player.hasShotgun) {
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < MAX_BULLETS; j++) {
+				if (!bullets[j].active) {
+					float offsetX = (i - 1) * 15.0f;
+					bullets[j].position = (Vector2){ 
+						player.position.x + offsetX, 
+						player.position.y - 30 
+					};
+					bullets[j].speed = (Vector2){ 0, -12 };
+					bullets[j].radius = 6;
+					bullets[j].active = true;
+					bullets[j].color = YELLOW;
+					bullets[j].isPlayerBullet = true;
+					bullets[j].homing = false;
+					break;
 				}
-				
-				player.position = (Vector2){ screenWidth/2, screenHeight - 50 };
-			}
-			if (IsKeyPressed(KEY_T)) {
-				gameMode = TIMED_MODE;
 			}
-			if (IsKeyPressed(KEY_I)) {
-				gameMode = INFINITE_MODE;
-			}
-			if (IsKeyPressed(KEY_H)) {
-				gameState = INSTRUCTIONS;
+		}
+	} else {
+		for (int i = 0; i < MAX_BULLETS; i++) {
+			if (!bullets[i].active) {
+				bullets[i].position = (Vector2){ player.position.x, player.position.y - 30 };
+				bullets[i].speed = (Vector2){ 0, -12 };
+				bullets[i].radius = 6;
+				bullets[i].active = true;
+				bullets[i].color = YELLOW;
+				bullets[i].isPlayerBullet = true;
+				bullets[i].homing = false;
+				break;
 			}
-			break;
-			
-		case INSTRUCTIONS:
-			if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_ESCAPE)) {
-				gameState = MENU;
+		}
+	}
+	
+	// One missile from each wing; they pick their own targets in flight
+	if (player.hasHoming) {
+		for (int side = -1; side <= 1; side += 2) {
+			for (int j = 0; j < MAX_BULLETS; j++) {
+				if (!bullets[j].active) {
+					bullets[j].position = (Vector2){ player.position.x + side * player.radius, player.position.y };
+					bullets[j].speed = (Vector2){ side * MISSILE_SPEED * 0.5f, -MISSILE_SPEED * 0.85f };
+					bullets[j].radius = 5;
+					bullets[j].active = true;
+					bullets[j].color = PINK;
+					bullets[j].isPlayerBullet = true;
+					bullets[j].homing = true;
+					bullets[j].life = MISSILE_LIFETIME;
+					break;
+				}
 			}
+		}
+	}
+	TelemetryWrite(&telemetry, TELEMETRY_SHOT, 0, 0.0f, (player.hasShotgun ? 3 : 1) + (player.hasHoming ? 2 : 0), 0);
+	PlaySfx(&audio, SFX_SHOT, player.position.x / screenWidth);
+}
+
+static void FireEliteShot(Enemy *self) {
+	for (int j = 0; j < MAX_BULLETS; j++) {
+		if (!bullets[j].active) {
+			bullets[j].position = (Vector2){ 
+				self->position.x, 
+				self->position.y + self->radius 
+			};
+			bullets[j].speed = (Vector2){ 0, 6 };
+			bullets[j].radius = 5;
+			bullets[j].active = true;
+			bullets[j].color = PURPLE;
+			bullets[j].isPlayerBullet = false;
+			bullets[j].owner = ELITE_ENEMY;
+			bullets[j].homing = false;
+			bullets[j].damage = 1;
 			break;
-			
-		case PLAYING:
-			if (IsKeyPressed(KEY_P)) {
-				gameState = PAUSED;
+		}
+	}
+}
+
+static void FireBossVolley(Enemy *self) {
+	for (int k = 0; k < director.patternBullets; k++) {
+		for (int j = 0; j < MAX_BULLETS; j++) {
+			if (!bullets[j].active) {
+				float offsetX = (k - (director.patternBullets - 1) * 0.5f) * 20.0f;
+				bullets[j].position = (Vector2){ 
+					self->position.x + offsetX, 
+					self->position.y + self->radius 
+				};
+				bullets[j].speed = (Vector2){ 0, 5 };
+				bullets[j].radius = (director.patternBullets == 1) ? 12 : 7;
+				bullets[j].active = true;
+				bullets[j].color = ORANGE;
+				bullets[j].isPlayerBullet = false;
+				bullets[j].owner = BOSS_ENEMY;
+				bullets[j].homing = false;
+				// A single shot carries the damage of the whole 3-bullet spread
+				bullets[j].damage = (director.patternBullets == 1) ? 3 : 1;
+				break;
 			}
+		}
+	}
+}
+
+static Vector2 RandomPointInArea(Rectangle area) {
+	return (Vector2){ 
+		(float)GetRandomValue((int)area.x, (int)(area.x + area.width)), 
+		(float)GetRandomValue((int)area.y, (int)(area.y + area.height)) 
+	};
+}
+
+// Indexes the enemies alive right now. Built once per tick, before the bomb
+// and the missiles query it.
+static void BuildTargetTree(void) {
+	ResetKdTree(&targetTree);
+	for (int i = 0; i < MAX_ENEMIES; i++) {
+		if (enemies[i].active) {
+			KdTreeAdd(&targetTree, enemies[i].position, i);
+		}
+	}
+	BuildKdTree(&targetTree);
+}
+
+// Turns a missile towards the nearest enemy in this tick's target tree. With
+// nothing to chase (or its target already killed this tick) it keeps its
+// heading.
+static void SteerMissile(Bullet *missile) {
+	int target = KdNearest(&targetTree, missile->position);
+	if (target < 0 || !enemies[target].active) {
+		return;
+	}
+	
+	float dx = enemies[target].position.x - missile->position.x;
+	float dy = enemies[target].position.y - missile->position.y;
+	float distance = sqrtf(dx*dx + dy*dy);
+	if (distance < 1.0f) {
+		return;
+	}
+	missile->speed.x += (dx / distance * MISSILE_SPEED - missile->speed.x) * MISSILE_TURN_RATE;
+	missile->speed.y += (dy / distance * MISSILE_SPEED - missile->speed.y) * MISSILE_TURN_RATE;
+	
+	float speed = sqrtf(missile->speed.x*missile->speed.x + missile->speed.y*missile->speed.y);
+	if (speed > 0.0f) {
+		missile->speed.x *= MISSILE_SPEED / speed;
+		missile->speed.y *= MISSILE_SPEED / speed;
+	}
+}
+
+static BehaviourTask EliteBehaviour(Enemy *self) {
+	for (;;) {
+		co_await WaitSeconds{ &self->behaviour, 2.0f };
+		FireEliteShot(self);
+	}
+}
+
+// Drops into the arena, then roams it firing volleys. Below half health it
+// moves and fires faster.
+static BehaviourTask BossBehaviour(Enemy *self) {
+	co_await MoveTo{ &self->behaviour, (Vector2){ bossArea.x + bossArea.width/2, bossArea.y + 60 }, 1.5f };
+	
+	while (self->health > self->maxHealth/2) {
+		SetCourse(&self->behaviour, RandomPointInArea(bossArea), 2.0f);
+		co_await WaitSeconds{ &self->behaviour, 1.5f };
+		FireBossVolley(self);
+	}
+	
+	for (;;) {
+		SetCourse(&self->behaviour, RandomPointInArea(bossArea), 3.0f);
+		co_await WaitSeconds{ &self->behaviour, 1.0f };
+		FireBossVolley(self);
+	}
+}
+
+static void UpdateGame(float dt) {
+	BeginInputTick(&input);
+	BeginAudioTick(&audio);
+	
+	if (InputPressed(&input, KEY_F3)) {
+		showProfiler = !showProfiler;
+	}
+	if (InputPressed(&input, KEY_F4)) {
+		lowLatencyPacing = !lowLatencyPacing;
+	}
+	if (InputPressed(&input, KEY_F9)) {
+		if (capture.active) {
+			StopCapture(&capture);
+		} else {
+			StartCapture(&capture, GetRenderWidth(), GetRenderHeight());
+		}
+	}
+	
+	if (gameState != PAUSED) {
+		UpdateStarfield(&starfield, dt);
+	}
+	
+	switch (gameState) {
+	case MENU:
+		if (InputPressed(&input, KEY_ENTER)) {
+			gameState = PLAYING;
+			achievements.gamesPlayed++;
+			TelemetryBeginSession(&telemetry, gameMode);
 			
-			if (gameMode == TIMED_MODE) {
-				timeElapsed += GetFrameTime();
-				gameTime = 60.0f - timeElapsed;
-				if (gameTime <= 0) {
-					gameTime = 0;
-					if (score > highScores.timedModeHighScore) {
-						highScores.timedModeHighScore = score;
-					}
-					gameState = TIME_UP;
-				}
-			} else {
-				if (!bossAlive) {
-					minuteTimer += GetFrameTime();
-					if (minuteTimer >= 60.0f) {
-						minuteTimer = 0.0f;
-						level++;
-						
-						if (level % 5 == 0) {
-							player.maxBombs++;
-							player.bombDamage += 5;
-						}
-					}
-				}
-				
-				if (score >= 3000 && !achievements.pilotAchieved) {
-					achievements.pilotAchieved = true;
-				}
+			if (achievements.gamesPlayed >= 10 && !achievements.hobbyistAchieved) {
+				achievements.hobbyistAchieved = true;
 			}
+			SaveProgress(&profileSaver, &highScores, &achievements);
 			
-			if (player.hasShotgun) {
-				player.shotgunTimer -= GetFrameTime();
-				if (player.shotgunTimer <= 0) {
-					player.hasShotgun = false;
-				}
+			leaderboardRank = -1;
+			StartGame();
+		}
+		if (InputPressed(&input, KEY_T)) {
+			gameMode = TIMED_MODE;
+		}
+		if (InputPressed(&input, KEY_I)) {
+			gameMode = INFINITE_MODE;
+		}
+		if (InputPressed(&input, KEY_H)) {
+			gameState = INSTRUCTIONS;
+		}
+		break;
+		
+	case INSTRUCTIONS:
+		if (InputPressed(&input, KEY_ENTER) || InputPressed(&input, KEY_ESCAPE)) {
+			gameState = MENU;
+		}
+		break;
+		
+	case PLAYING:
+		TelemetryWrite(&telemetry, TELEMETRY_FRAME, 0, dt*1000.0f, score, level);
+		
+		if (UpdateDirector(&director, frameSimMs, frameDrawMs, dt)) {
+			TelemetryWrite(&telemetry, TELEMETRY_DIRECTOR, director.patternBullets, director.density, 
+						   (int)(director.simMs*1000.0f), (int)(director.drawMs*1000.0f));
+			TraceLog(LOG_INFO, "DIRECTOR: sim %.2f ms + draw %.2f ms -> density %.2f, boss volley %d", 
+					 director.simMs, director.drawMs, director.density, director.patternBullets);
+		}
+		
+		if (InputPressed(&input, KEY_P)) {
+			gameState = PAUSED;
+		}
+		
+		if (gameMode == TIMED_MODE) {
+			timeElapsed += dt;
+			gameTime = 60.0f - timeElapsed;
+			if (gameTime <= 0) {
+				gameTime = 0;
+				leaderboardRank = LeaderboardInsert(&highScores.boards[TIMED_MODE], score, level, time(NULL));
+				SaveProgress(&profileSaver, &highScores, &achievements);
+				gameState = TIME_UP;
+				TelemetryEndSession(&telemetry, gameMode, score, level);
 			}
-			
-			if (bombEffect.active) {
-				bombEffect.timer -= GetFrameTime();
-				if (bombEffect.timer <= 0) {
-					bombEffect.active = false;
+		} else {
+			if (!bossAlive) {
+				minuteTimer += dt;
+				if (minuteTimer >= 60.0f) {
+					minuteTimer = 0.0f;
+					level++;
+					
+					if (level % 5 == 0) {
+						player.maxBombs++;
+						player.bombDamage += 5;
+					}
 				}
 			}
 			
-			if (IsKeyDown(KEY_RIGHT) && player.position.x < screenWidth - player.radius) {
-				player.position.x += player.speed.x;
+			if (score >= 3000 && !achievements.pilotAchieved) {
+				achievements.pilotAchieved = true;
+				SaveProgress(&profileSaver, &highScores, &achievements);
 			}
-			if (IsKeyDown(KEY_LEFT) && player.position.x > player.radius) {
-				player.position.x -= player.speed.x;
+		}
+		
+		if (bossAlive) {
+			bossFightTime += dt;
+		}
+		
+		if (player.hasShotgun) {
+			player.shotgunTimer -= dt;
+			if (player.shotgunTimer <= 0) {
+				player.hasShotgun = false;
 			}
-			if (IsKeyDown(KEY_UP) && player.position.y > player.radius) {
-				player.position.y -= player.speed.y;
+		}
+		
+		if (player.hasHoming) {
+			player.homingTimer -= dt;
+			if (player.homingTimer <= 0) {
+				player.hasHoming = false;
 			}
-			if (IsKeyDown(KEY_DOWN) && player.position.y < screenHeight - player.radius) {
-				player.position.y += player.speed.y;
+		}
+		
+		if (bombEffect.active) {
+			bombEffect.timer -= dt;
+			if (bombEffect.timer <= 0) {
+				bombEffect.active = false;
 			}
+		}
+		
+		if (IsKeyDown(KEY_RIGHT) && player.position.x < screenWidth - player.radius) {
+			player.position.x += player.speed.x;
+		}
+		if (IsKeyDown(KEY_LEFT) && player.position.x > player.radius) {
+			player.position.x -= player.speed.x;
+		}
+		if (IsKeyDown(KEY_UP) && player.position.y > player.radius) {
+			player.position.y -= player.speed.y;
+		}
+		if (IsKeyDown(KEY_DOWN) && player.position.y < screenHeight - player.radius) {
+			player.position.y += player.speed.y;
+		}
+		
+		BuildTargetTree();
+		
+		// Every press since the last tick fires, even taps released before the poll
+		for (int presses = InputPressCount(&input, KEY_SPACE); presses > 0; presses--) {
+			FirePlayerShot();
+		}
+		
+		if (InputPressed(&input, KEY_B) && player.bombCount > 0) {
+			player.bombCount--;
+			bombEffect.position = player.position;
+			bombEffect.radius = BOMB_RADIUS;
+			bombEffect.timer = BOMB_DURATION;
+			bombEffect.active = true;
 			
-			if (IsKeyPressed(KEY_SPACE)) {
-				if (player.hasShotgun) {
-					for (int i = 0; i < 3; i++) {
-						for (int j = 0; j < MAX_BULLETS; j++) {
-							if (!bullets[j].active) {
-								float offsetX = (i - 1) * 15.0f;
-								bullets[j].position = (Vector2){ 
-									player.position.x + offsetX, 
-									player.position.y - 30 
-								};
-								bullets[j].speed = (Vector2){ 0, -12 };
-								bullets[j].radius = 6;
-								bullets[j].active = true;
-								bullets[j].color = YELLOW;
-								bullets[j].isPlayerBullet = true;
-								break;
-							}
-						}
-					}
-				} else {
-					for (int i = 0; i < MAX_BULLETS; i++) {
-						if (!bullets[i].active) {
-							bullets[i].position = (Vector2){ player.position.x, player.position.y - 30 };
-							bullets[i].speed = (Vector2){ 0, -12 };
-							bullets[i].radius = 6;
-							bullets[i].active = true;
-							bullets[i].color = YELLOW;
-							bullets[i].isPlayerBullet = true;
-							break;
-						}
+			int caught[MAX_ENEMIES];
+			int bombHits = KdRadius(&targetTree, bombEffect.position, bombEffect.radius, caught, MAX_ENEMIES);
+			int bombKills = 0;
+			for (int k = 0; k < bombHits; k++) {
+				int i = caught[k];
+				enemies[i].health -= player.bombDamage;
+				if (enemies[i].health <= 0) {
+					bombKills++;
+					PlaySfx(&audio, SFX_EXPLOSION, enemies[i].position.x / screenWidth);
+					enemies[i].active = false;
+					score += enemies[i].scoreValue;
+					if (enemies[i].type == BOSS_ENEMY) {
+						bossAlive = false;
+						TelemetryWrite(&telemetry, TELEMETRY_BOSS_KILL, 0, bossFightTime, level, 0);
 					}
 				}
 			}
+			TelemetryWrite(&telemetry, TELEMETRY_BOMB, 0, 0.0f, bombHits, bombKills);
+			PlaySfx(&audio, SFX_BOMB, bombEffect.position.x / screenWidth);
+		}
+		
+		enemySpawnTimer += dt;
+		if (enemySpawnTimer >= DirectorSpawnInterval(&director, enemySpawnInterval)) {
+			enemySpawnTimer = 0;
 			
-			if (IsKeyPressed(KEY_B) && player.bombCount > 0) {
-				player.bombCount--;
-				bombEffect.position = player.position;
-				bombEffect.radius = BOMB_RADIUS;
-				bombEffect.timer = BOMB_DURATION;
-				bombEffect.active = true;
-				
-				for (int i = 0; i < MAX_ENEMIES; i++) {
-					if (enemies[i].active) {
-						float dx = enemies[i].position.x - bombEffect.position.x;
-						float dy = enemies[i].position.y - bombEffect.position.y;
-						float distance = sqrt(dx*dx + dy*dy);
-						
-						if (distance < bombEffect.radius) {
-							enemies[i].health -= player.bombDamage;
-							if (enemies[i].health <= 0) {
-								enemies[i].active = false;
-								score += enemies[i].scoreValue;
-								if (enemies[i].type == BOSS_ENEMY) {
-									bossAlive = false;
-								}
-							}
-						}
-					}
+			for (int i = 0; i < MAX_ENEMIES; i++) {
+				if (!enemies[i].active && enemies[i].type == NORMAL_ENEMY) {
+					enemies[i].position = (Vector2){ 
+						GetRandomValue(50, screenWidth - 50), 
+						-30 
+					};
+					enemies[i].speed = (Vector2){ 
+						0, 
+						GetRandomValue(3, 6) 
+					};
+					enemies[i].radius = 20;
+					enemies[i].active = true;
+					enemies[i].color = RED;
+					enemies[i].type = NORMAL_ENEMY;
+					enemies[i].health = DirectorScale(&director, (gameMode == INFINITE_MODE && !bossAlive) ? level : 1);
+					enemies[i].maxHealth = enemies[i].health;
+					enemies[i].scoreValue = DirectorScale(&director, 10);
+					ReleaseBehaviour(&enemies[i].behaviour);
+					break;
 				}
 			}
+		}
+		
+		if ((gameMode == TIMED_MODE && GetRandomValue(0, 100) < 5) || 
+			(gameMode == INFINITE_MODE && level >= 2 && !bossAlive)) {
 			
-			enemySpawnTimer += GetFrameTime();
-			if (enemySpawnTimer >= enemySpawnInterval) {
-				enemySpawnTimer = 0;
+			eliteSpawnTimer += dt;
+			if (eliteSpawnTimer >= DirectorSpawnInterval(&director, eliteSpawnInterval)) {
+				eliteSpawnTimer = 0;
 				
 				for (int i = 0; i < MAX_ENEMIES; i++) {
-					if (!enemies[i].active && enemies[i].type == NORMAL_ENEMY) {
+					if (!enemies[i].active && enemies[i].type != BOSS_ENEMY) {
 						enemies[i].position = (Vector2){ 
 							GetRandomValue(50, screenWidth - 50), 
 							-30 
 						};
 						enemies[i].speed = (Vector2){ 
 							0, 
-							GetRandomValue(3, 6) 
+							GetRandomValue(3, 5) 
 						};
-						enemies[i].radius = 20;
+						enemies[i].radius = 22;
 						enemies[i].active = true;
-						enemies[i].color = RED;
-						enemies[i].type = NORMAL_ENEMY;
-						enemies[i].health = (gameMode == INFINITE_MODE && !bossAlive) ? level : 1;
-						enemies[i].maxHealth = (gameMode == INFINITE_MODE && !bossAlive) ? level : 1;
-						enemies[i].shootTimer = 0.0f;
-						enemies[i].shootInterval = 0.0f;
-						enemies[i].scoreValue = 10;
+						enemies[i].color = PURPLE;
+						enemies[i].type = ELITE_ENEMY;
+						enemies[i].health = DirectorScale(&director, (gameMode == INFINITE_MODE && !bossAlive) ? (3 + level/2) : 2);
+						enemies[i].maxHealth = enemies[i].health;
+						enemies[i].scoreValue = DirectorScale(&director, 25);
+						StartBehaviour(&enemies[i].behaviour, EliteBehaviour(&enemies[i]));
 						break;
 					}
 				}
 			}
-			
-			if ((gameMode == TIMED_MODE && GetRandomValue(0, 100) < 5) || 
-				(gameMode == INFINITE_MODE && level >= 2 && !bossAlive)) {
+		}
+		
+		if (gameMode == INFINITE_MODE && level % 5 == 0 && !bossAlive) {
+			bossSpawnTimer += dt;
+			if (bossSpawnTimer >= bossSpawnInterval) {
+				bossSpawnTimer = 0;
+				bossAlive = true;
+				bossFightTime = 0.0f;
+				TelemetryWrite(&telemetry, TELEMETRY_BOSS_SPAWN, 0, 0.0f, level, 10 + (level/5 - 1) * 10);
+				PlaySfx(&audio, SFX_BOSS_SPAWN, 0.5f);
 				
-				eliteSpawnTimer += GetFrameTime();
-				if (eliteSpawnTimer >= eliteSpawnInterval) {
-					eliteSpawnTimer = 0;
-					
-					for (int i = 0; i < MAX_ENEMIES; i++) {
-						if (!enemies[i].active && enemies[i].type != BOSS_ENEMY) {
-							enemies[i].position = (Vector2){ 
-								GetRandomValue(50, screenWidth - 50), 
-								-30 
-							};
-							enemies[i].speed = (Vector2){ 
-								0, 
-								GetRandomValue(3, 5) 
-							};
-							enemies[i].radius = 22;
-							enemies[i].active = true;
-							enemies[i].color = PURPLE;
-							enemies[i].type = ELITE_ENEMY;
-							enemies[i].health = (gameMode == INFINITE_MODE && !bossAlive) ? (3 + level/2) : 2;
-							enemies[i].maxHealth = (gameMode == INFINITE_MODE && !bossAlive) ? (3 + level/2) : 2;
-							enemies[i].shootTimer = 0.0f;
-							enemies[i].shootInterval = 2.0f;
-							enemies[i].scoreValue = 25;
-							break;
-						}
+				for (int i = 0; i < MAX_ENEMIES; i++) {
+					if (!enemies[i].active && enemies[i].type != ELITE_ENEMY) {
+						enemies[i].position = (Vector2){ 
+							bossArea.x + bossArea.width/2, 
+							bossArea.y - 60 
+						};
+						enemies[i].speed = (Vector2){ 0, 0 };
+						enemies[i].radius = 35;
+						enemies[i].active = true;
+						enemies[i].color = ORANGE;
+						enemies[i].type = BOSS_ENEMY;
+						enemies[i].health = 10 + (level/5 - 1) * 10;
+						enemies[i].maxHealth = 10 + (level/5 - 1) * 10;
+						enemies[i].scoreValue = 100 + (level/5) * 50;
+						StartBehaviour(&enemies[i].behaviour, BossBehaviour(&enemies[i]));
+						break;
 					}
 				}
 			}
-			
-			if (gameMode == INFINITE_MODE && level % 5 == 0 && !bossAlive) {
-				bossSpawnTimer += GetFrameTime();
-				if (bossSpawnTimer >= bossSpawnInterval) {
-					bossSpawnTimer = 0;
-					bossAlive = true;
-					
-					for (int i = 0; i < MAX_ENEMIES; i++) {
-						if (!enemies[i].active && enemies[i].type != ELITE_ENEMY) {
-							enemies[i].position = (Vector2){ 
-								bossArea.x + bossArea.width/2, 
-								bossArea.y - 60 
-							};
-							enemies[i].speed = (Vector2){ 
-								GetRandomValue(-3, 3), 
-								1.5f 
-							};
-							enemies[i].radius = 35;
-							enemies[i].active = true;
-							enemies[i].color = ORANGE;
-							enemies[i].type = BOSS_ENEMY;
-							enemies[i].health = 10 + (level/5 - 1) * 10;
-							enemies[i].maxHealth = 10 + (level/5 - 1) * 10;
-							enemies[i].shootTimer = 0.0f;
-							enemies[i].shootInterval = 1.5f;
-							enemies[i].scoreValue = 100 + (level/5) * 50;
+		}
+		
+		if (gameMode == INFINITE_MODE && !bossAlive) {
+			powerupSpawnTimer += dt;
+			if (powerupSpawnTimer >= powerupSpawnInterval) {
+				powerupSpawnTimer = 0;
+				
+				for (int i = 0; i < MAX_POWERUPS; i++) {
+					if (!powerups[i].active) {
+						PowerUpType type = (PowerUpType)GetRandomValue(0, 3);
+						powerups[i].position = (Vector2){ 
+							GetRandomValue(50, screenWidth - 50), 
+							-30 
+						};
+						powerups[i].speed = (Vector2){ 0, 4 };
+						powerups[i].radius = 12;
+						powerups[i].active = true;
+						powerups[i].type = type;
+						powerups[i].duration = 5.0f;
+						
+						switch (type) {
+						case SHOTGUN_POWERUP:
+							powerups[i].color = GREEN;
 							break;
-						}
-					}
-				}
-			}
-			
-			if (gameMode == INFINITE_MODE && !bossAlive) {
-				powerupSpawnTimer += GetFrameTime();
-				if (powerupSpawnTimer >= powerupSpawnInterval) {
-					powerupSpawnTimer = 0;
-					
-					for (int i = 0; i < MAX_POWERUPS; i++) {
-						if (!powerups[i].active) {
-							PowerUpType type = (PowerUpType)GetRandomValue(0, 2);
-							powerups[i].position = (Vector2){ 
-								GetRandomValue(50, screenWidth - 50), 
-								-30 
-							};
-							powerups[i].speed = (Vector2){ 0, 4 };
-							powerups[i].radius = 12;
-							powerups[i].active = true;
-							powerups[i].type = type;
-							powerups[i].duration = 5.0f;
-							
-							switch (type) {
-							case SHOTGUN_POWERUP:
-								powerups[i].color = GREEN;
-								break;
-							case HEALTH_POWERUP:
-								powerups[i].color = SKYBLUE;
-								break;
-							case BOMB_POWERUP:
-								powerups[i].color = RED;
-								break;
-							}
+						case HEALTH_POWERUP:
+							powerups[i].color = SKYBLUE;
+							break;
+						case BOMB_POWERUP:
+							powerups[i].color = RED;
+							break;
+						case HOMING_POWERUP:
+							powerups[i].color = PINK;
 							break;
 						}
+						break;
 					}
 				}
 			}
-			
-			for (int i = 0; i < MAX_BULLETS; i++) {
-				if (bullets[i].active) {
-					bullets[i].position.y += bullets[i].speed.y;
-					
-					if (bullets[i].position.y < 0) {
+		}
+		
+		BeginPerfPhase(&perfCounters, &simPhases[SIM_PHASE_BULLETS]);
+		for (int i = 0; i < MAX_BULLETS; i++) {
+			if (bullets[i].active) {
+				if (bullets[i].homing) {
+					SteerMissile(&bullets[i]);
+					bullets[i].life -= dt;
+					if (bullets[i].life <= 0 || bullets[i].position.x < 0 || bullets[i].position.x > screenWidth || 
+						bullets[i].position.y > screenHeight) {
 						bullets[i].active = false;
 					}
 				}
+				bullets[i].position.x += bullets[i].speed.x;
+				bullets[i].position.y += bullets[i].speed.y;
+				
+				if (bullets[i].position.y < 0) {
+					bullets[i].active = false;
+				}
+			}
+		}
+		EndPerfPhase(&perfCounters, &simPhases[SIM_PHASE_BULLETS]);
+		
+		BeginPerfPhase(&perfCounters, &simPhases[SIM_PHASE_ENEMIES]);
+		for (int i = 0; i < MAX_ENEMIES; i++) {
+			if (!enemies[i].active) {
+				ReleaseBehaviour(&enemies[i].behaviour);
+				continue;
 			}
 			
-			for (int i = 0; i < MAX_ENEMIES; i++) {
-				if (enemies[i].active) {
-					enemies[i].position.y += enemies[i].speed.y;
-					
-					if (enemies[i].type == BOSS_ENEMY) {
-						enemies[i].position.x += enemies[i].speed.x;
-						if (enemies[i].position.x < bossArea.x || enemies[i].position.x > bossArea.x + bossArea.width) {
-							enemies[i].speed.x *= -1;
-						}
-						if (enemies[i].position.y < bossArea.y || enemies[i].position.y > bossArea.y + bossArea.height) {
-							enemies[i].speed.y *= -1;
-						}
-					}
-					
-					if (enemies[i].position.y > screenHeight + 60) {
-						enemies[i].active = false;
-						if (enemies[i].type == BOSS_ENEMY) {
-							bossAlive = false;
-						}
-					}
-					
-					if (enemies[i].type == ELITE_ENEMY || enemies[i].type == BOSS_ENEMY) {
-						enemies[i].shootTimer += GetFrameTime();
-						if (enemies[i].shootTimer >= enemies[i].shootInterval) {
-							enemies[i].shootTimer = 0.0f;
-							
-							if (enemies[i].type == ELITE_ENEMY) {
-								for (int j = 0; j < MAX_BULLETS; j++) {
-									if (!bullets[j].active) {
-										bullets[j].position = (Vector2){ 
-											enemies[i].position.x, 
-											enemies[i].position.y + enemies[i].radius 
-										};
-										bullets[j].speed = (Vector2){ 0, 6 };
-										bullets[j].radius = 5;
-										bullets[j].active = true;
-										bullets[j].color = PURPLE;
-										bullets[j].isPlayerBullet = false;
-										break;
-									}
-								}
-							} else if (enemies[i].type == BOSS_ENEMY) {
-								for (int k = 0; k < 3; k++) {
-									for (int j = 0; j < MAX_BULLETS; j++) {
-										if (!bullets[j].active) {
-											float offsetX = (k - 1) * 20.0f;
-											bullets[j].position = (Vector2){ 
-												enemies[i].position.x + offsetX, 
-												enemies[i].position.y + enemies[i].radius 
-											};
-											bullets[j].speed = (Vector2){ 0, 5 };
-											bullets[j].radius = 7;
-											bullets[j].active = true;
-											bullets[j].color = ORANGE;
-											bullets[j].isPlayerBullet = false;
-											break;
-										}
-									}
-								}
-							}
-						}
-					}
+			enemies[i].position.y += enemies[i].speed.y;
+			StepBehaviour(&enemies[i].behaviour, &enemies[i].position, dt);
+			
+			if (enemies[i].position.y > screenHeight + 60) {
+				enemies[i].active = false;
+				if (enemies[i].type == BOSS_ENEMY) {
+					bossAlive = false;
 				}
 			}
-			
-			for (int i = 0; i < MAX_POWERUPS; i++) {
-				if (powerups[i].active) {
-					powerups[i].position.y += powerups[i].speed.y;
-					
-					if (powerups[i].position.y > screenHeight + 30) {
-						powerups[i].active = false;
-					}
+		}
+		EndPerfPhase(&perfCounters, &simPhases[SIM_PHASE_ENEMIES]);
+		
+		for (int i = 0; i < MAX_POWERUPS; i++) {
+			if (powerups[i].active) {
+				powerups[i].position.y += powerups[i].speed.y;
+				
+				if (powerups[i].position.y > screenHeight + 30) {
+					powerups[i].active = false;
 				}
 			}
-			
-			for (int i = 0; i < MAX_BULLETS; i++) {
-				if (bullets[i].active && bullets[i].isPlayerBullet) {
-					for (int j = 0; j < MAX_ENEMIES; j++) {
-						if (enemies[j].active) {
-							float dx = bullets[i].position.x - enemies[j].position.x;
-							float dy = bullets[i].position.y - enemies[j].position.y;
-							float distance = sqrt(dx*dx + dy*dy);
-							
-							if (distance < bullets[i].radius + enemies[j].radius) {
-								bullets[i].active = false;
-								enemies[j].health--;
-								if (enemies[j].health <= 0) {
-									enemies[j].active = false;
-									score += enemies[j].scoreValue;
-									if (enemies[j].type == BOSS_ENEMY) {
-										bossAlive = false;
-									}
+		}
+		
+		BeginPerfPhase(&perfCounters, &simPhases[SIM_PHASE_COLLISIONS]);
+		for (int i = 0; i < MAX_BULLETS; i++) {
+			if (bullets[i].active && bullets[i].isPlayerBullet) {
+				for (int j = 0; j < MAX_ENEMIES; j++) {
+					if (enemies[j].active) {
+						float dx = bullets[i].position.x - enemies[j].position.x;
+						float dy = bullets[i].position.y - enemies[j].position.y;
+						float distance = sqrt(dx*dx + dy*dy);
+						
+						if (distance < bullets[i].radius + enemies[j].radius) {
+							bullets[i].active = false;
+							enemies[j].health--;
+							TelemetryWrite(&telemetry, TELEMETRY_HIT, enemies[j].type, 0.0f, enemies[j].health <= 0, 0);
+							PlaySfx(&audio, (enemies[j].health <= 0) ? SFX_EXPLOSION : SFX_HIT, enemies[j].position.x / screenWidth);
+							if (enemies[j].health <= 0) {
+								enemies[j].active = false;
+								score += enemies[j].scoreValue;
+								if (enemies[j].type == BOSS_ENEMY) {
+									bossAlive = false;
+									TelemetryWrite(&telemetry, TELEMETRY_BOSS_KILL, 0, bossFightTime, level, 0);
 								}
 							}
 						}
 					}
 				}
 			}
-			
-			for (int i = 0; i < MAX_BULLETS; i++) {
-				if (bullets[i].active && !bullets[i].isPlayerBullet) {
-					float dx = player.position.x - bullets[i].position.x;
-					float dy = player.position.y - bullets[i].position.y;
-					float distance = sqrt(dx*dx + dy*dy);
+		}
+		
+		for (int i = 0; i < MAX_BULLETS; i++) {
+			if (bullets[i].active && !bullets[i].isPlayerBullet) {
+				float dx = player.position.x - bullets[i].position.x;
+				float dy = player.position.y - bullets[i].position.y;
+				float distance = sqrt(dx*dx + dy*dy);
+				
+				if (distance < player.radius + bullets[i].radius) {
+					bullets[i].active = false;
+					player.health -= bullets[i].damage;
+					TelemetryWrite(&telemetry, TELEMETRY_DAMAGE, bullets[i].owner, (float)bullets[i].damage, TELEMETRY_DAMAGE_BULLET, 0);
+					PlaySfx(&audio, SFX_PLAYER_HIT, player.position.x / screenWidth);
 					
-					if (distance < player.radius + bullets[i].radius) {
-						bullets[i].active = false;
-						player.health--;
-						
-						if (player.health <= 0) {
-							if (gameMode == INFINITE_MODE && score > highScores.infiniteModeHighScore) {
-								highScores.infiniteModeHighScore = score;
-							}
-							gameState = GAME_OVER;
+					if (player.health <= 0 && gameState != GAME_OVER) {
+						if (gameMode == INFINITE_MODE) {
+							leaderboardRank = LeaderboardInsert(&highScores.boards[INFINITE_MODE], score, level, time(NULL));
+							SaveProgress(&profileSaver, &highScores, &achievements);
 						}
+						gameState = GAME_OVER;
+						TelemetryEndSession(&telemetry, gameMode, score, level);
 					}
 				}
 			}
-			
-			for (int i = 0; i < MAX_ENEMIES; i++) {
-				if (enemies[i].active) {
-					float dx = player.position.x - enemies[i].position.x;
-					float dy = player.position.y - enemies[i].position.y;
-					float distance = sqrt(dx*dx + dy*dy);
+		}
+		
+		for (int i = 0; i < MAX_ENEMIES; i++) {
+			if (enemies[i].active) {
+				float dx = player.position.x - enemies[i].position.x;
+				float dy = player.position.y - enemies[i].position.y;
+				float distance = sqrt(dx*dx + dy*dy);
+				
+				if (distance < player.radius + enemies[i].radius) {
+					enemies[i].active = false;
+					player.health--;
+					TelemetryWrite(&telemetry, TELEMETRY_DAMAGE, enemies[i].type, 1.0f, TELEMETRY_DAMAGE_COLLISION, 0);
+					PlaySfx(&audio, SFX_PLAYER_HIT, player.position.x / screenWidth);
 					
-					if (distance < player.radius + enemies[i].radius) {
-						enemies[i].active = false;
-						player.health--;
-						
-						if (player.health <= 0) {
-							if (gameMode == INFINITE_MODE && score > highScores.infiniteModeHighScore) {
-								highScores.infiniteModeHighScore = score;
-							}
-							gameState = GAME_OVER;
+					if (player.health <= 0 && gameState != GAME_OVER) {
+						if (gameMode == INFINITE_MODE) {
+							leaderboardRank = LeaderboardInsert(&highScores.boards[INFINITE_MODE], score, level, time(NULL));
+							SaveProgress(&profileSaver, &highScores, &achievements);
 						}
+						gameState = GAME_OVER;
+						TelemetryEndSession(&telemetry, gameMode, score, level);
 					}
 				}
 			}
-			
-			for (int i = 0; i < MAX_POWERUPS; i++) {
-				if (powerups[i].active) {
-					float dx = player.position.x - powerups[i].position.x;
-					float dy = player.position.y - powerups[i].position.y;
-					float distance = sqrt(dx*dx + dy*dy);
-					
-					if (distance < player.radius + powerups[i].radius) {
-						powerups[i].active = false;
-						if (powerups[i].type == SHOTGUN_POWERUP) {
-							player.hasShotgun = true;
-							player.shotgunTimer = powerups[i].duration;
-						} else if (powerups[i].type == HEALTH_POWERUP) {
-							if (player.health < player.maxHealth) {
-								player.health++;
-							} else {
-								player.maxHealth++;
-								player.health = player.maxHealth;
-							}
-						} else if (powerups[i].type == BOMB_POWERUP) {
-							if (player.bombCount < player.maxBombs) {
-								player.bombCount++;
-							}
+		}
+		
+		for (int i = 0; i < MAX_POWERUPS; i++) {
+			if (powerups[i].active) {
+				float dx = player.position.x - powerups[i].position.x;
+				float dy = player.position.y - powerups[i].position.y;
+				float distance = sqrt(dx*dx + dy*dy);
+				
+				if (distance < player.radius + powerups[i].radius) {
+					powerups[i].active = false;
+					PlaySfx(&audio, SFX_PICKUP, powerups[i].position.x / screenWidth);
+					if (powerups[i].type == SHOTGUN_POWERUP) {
+						player.hasShotgun = true;
+						player.shotgunTimer = powerups[i].duration;
+					} else if (powerups[i].type == HEALTH_POWERUP) {
+						if (player.health < player.maxHealth) {
+							player.health++;
+						} else {
+							player.maxHealth++;
+							player.health = player.maxHealth;
 						}
+					} else if (powerups[i].type == BOMB_POWERUP) {
+						if (player.bombCount < player.maxBombs) {
+							player.bombCount++;
+						}
+					} else if (powerups[i].type == HOMING_POWERUP) {
+						player.hasHoming = true;
+						player.homingTimer = powerups[i].duration;
 					}
 				}
 			}
-			break;
-			
-		case PAUSED:
-			if (IsKeyPressed(KEY_P)) {
-				gameState = PLAYING;
-			}
-			if (IsKeyPressed(KEY_R)) {
-				gameState = MENU;
-			}
-			break;
-			
-		case GAME_OVER:
-			if (IsKeyPressed(KEY_R)) {
-				gameState = MENU;
-			}
-			break;
-			
-		case TIME_UP:
-			if (IsKeyPressed(KEY_R)) {
-				gameState = MENU;
-			}
-			break;
 		}
+		EndPerfPhase(&perfCounters, &simPhases[SIM_PHASE_COLLISIONS]);
+		break;
 		
-		BeginDrawing();
-		ClearBackground(BLACK);
+	case PAUSED:
+		if (InputPressed(&input, KEY_P)) {
+			gameState = PLAYING;
+		}
+		if (InputPressed(&input, KEY_R)) {
+			gameState = MENU;
+			TelemetryEndSession(&telemetry, gameMode, score, level);
+		}
+		break;
+		
+	case GAME_OVER:
+		if (InputPressed(&input, KEY_R)) {
+			gameState = MENU;
+		}
+		break;
 		
-		if (gameState == PLAYING || gameState == PAUSED) {
+	case TIME_UP:
+		if (InputPressed(&input, KEY_R)) {
+			gameState = MENU;
+		}
+		break;
+	}
+}
+
+static void DrawProfiler(void) {
+	float latencyAvg, latencyMax;
+	LatencySummary(&inputLatency, &latencyAvg, &latencyMax);
+	
+	AudioStats audioStats = GetAudioStats(&audio);
+	CaptureStats captureStats = GetCaptureStats(&capture);
+	
+	DrawRectangle(10, screenHeight - 255, 400, 245, Fade(BLACK, 0.7f));
+	DrawText(TextFormat("Audio: %d voices (peak %d), %.0f us/mix, %d limited", audioStats.activeVoices, 
+						audioStats.peakVoices, audioStats.mixUs, audioStats.rateLimited), 20, screenHeight - 245, 20, WHITE);
+	if (capture.active) {
+		DrawText(TextFormat("REC %d (%d dropped) %.2f ms, enc %.1f ms", captureStats.captured, captureStats.dropped, 
+							captureStats.overheadMs, captureStats.encodeMs), 20, screenHeight - 220, 20, RED);
+	} else {
+		DrawText("Capture: off (F9)", 20, screenHeight - 220, 20, WHITE);
+	}
+	DrawText(TextFormat("Startup: %.0f ms (assets %.1f ms%s)", startupMs, assets.loadMs, assets.loaded ? "" : ", none"), 
+			 20, screenHeight - 195, 20, WHITE);
+	DrawText(TextFormat("Pacing: %s (F4)", lowLatencyPacing ? "LOW LATENCY" : "CLASSIC"), 20, screenHeight - 170, 20, 
+			 lowLatencyPacing ? GREEN : WHITE);
+	DrawText(TextFormat("Input->present: %.1f ms (avg %.1f, max %.1f)", inputLatency.lastMs, latencyAvg, latencyMax), 
+			 20, screenHeight - 145, 20, WHITE);
+	DrawText(TextFormat("FPS: %d", GetFPS()), 20, screenHeight - 120, 20, LIME);
+	DrawText(TextFormat("Sim: %.2f ms  Draw: %.2f ms", frameSimMs, frameDrawMs), 20, screenHeight - 95, 20, WHITE);
+	DrawText(TextFormat("Budget: %.2f / %.1f ms", director.simMs + director.drawMs, DIRECTOR_BUDGET_MS), 20, screenHeight - 70, 20, WHITE);
+	DrawText(TextFormat("Density: %.2f  Volley: %d", director.density, director.patternBullets), 20, screenHeight - 45, 20, 
+			 director.density < 1.0f ? ORANGE : WHITE);
+}
+
+// Draws the current frame of a sprite group fitted to an entity's radius.
+// Returns false when the archive has no such sprite so the caller can fall
+// back to primitives.
+static bool DrawSprite(AssetGroup group, Vector2 center, float radius, Color tint) {
+	const AssetSprite *sprite = AssetGroupFrame(&assets, group, GetTime(), SPRITE_ANIMATION_FPS);
+	if (sprite == NULL) {
+		return false;
+	}
+	
+	float scale = radius*2.0f / fmaxf(sprite->width, sprite->height);
+	Rectangle source = { sprite->x, sprite->y, sprite->width, sprite->height };
+	Rectangle dest = { center.x, center.y, sprite->width*scale, sprite->height*scale };
+	DrawTexturePro(assets.atlas, source, dest, (Vector2){ dest.width/2, dest.height/2 }, 0.0f, tint);
+	return true;
+}
+
+static void DrawGame(void) {
+	ClearBackground(BLACK);
+	DrawStarfield(&starfield, screenWidth, screenHeight);
+	
+	if (gameState == PLAYING || gameState == PAUSED) {
+		if (!DrawSprite(ASSET_GROUP_PLAYER, player.position, player.radius, WHITE)) {
 			DrawCircleV(player.position, player.radius, player.color);
-			
-			for (int i = 0; i < MAX_BULLETS; i++) {
-				if (bullets[i].active) {
-					DrawCircleV(bullets[i].position, bullets[i].radius, bullets[i].color);
+		}
+		
+		for (int i = 0; i < MAX_BULLETS; i++) {
+			if (bullets[i].active) {
+				if (bullets[i].homing) {
+					Vector2 tail = { bullets[i].position.x - bullets[i].speed.x * 2.0f, bullets[i].position.y - bullets[i].speed.y * 2.0f };
+					DrawLineEx(tail, bullets[i].position, 3.0f, Fade(bullets[i].color, 0.5f));
 				}
+				DrawCircleV(bullets[i].position, bullets[i].radius, bullets[i].color);
 			}
-			
-			for (int i = 0; i < MAX_ENEMIES; i++) {
-				if (enemies[i].active) {
-					Color enemyColor = enemies[i].color;
-					if (enemies[i].type == ELITE_ENEMY) {
-						enemyColor = PURPLE;
-					} else if (enemies[i].type == BOSS_ENEMY) {
-						enemyColor = ORANGE;
-					}
-					
+		}
+		
+		for (int i = 0; i < MAX_ENEMIES; i++) {
+			if (enemies[i].active) {
+				Color enemyColor = enemies[i].color;
+				if (enemies[i].type == ELITE_ENEMY) {
+					enemyColor = PURPLE;
+				} else if (enemies[i].type == BOSS_ENEMY) {
+					enemyColor = ORANGE;
+				}
+				
+				AssetGroup group = (AssetGroup)(ASSET_GROUP_ENEMY_NORMAL + (int)enemies[i].type);
+				if (!DrawSprite(group, enemies[i].position, enemies[i].radius, WHITE)) {
 					DrawCircleV(enemies[i].position, enemies[i].radius, enemyColor);
 					
 					if (enemies[i].type == ELITE_ENEMY) {
@@ -741,165 +1070,650 @@ int main(void) {
 					} else if (enemies[i].type == BOSS_ENEMY) {
 						DrawText("B", enemies[i].position.x - 10, enemies[i].position.y - 12, 24, WHITE);
 					}
-					
-					if (enemies[i].maxHealth > 1) {
-						float healthBarWidth = enemies[i].radius * 2.5f;
-						float healthRatio = (float)enemies[i].health / enemies[i].maxHealth;
-						DrawRectangle(enemies[i].position.x - healthBarWidth/2, enemies[i].position.y - enemies[i].radius - 15, 
-									  healthBarWidth, 8, GRAY);
-						DrawRectangle(enemies[i].position.x - healthBarWidth/2, enemies[i].position.y - enemies[i].radius - 15, 
-									  healthBarWidth * healthRatio, 8, GREEN);
-					}
+				}
+				
+				if (enemies[i].maxHealth > 1) {
+					float healthBarWidth = enemies[i].radius * 2.5f;
+					float healthRatio = (float)enemies[i].health / enemies[i].maxHealth;
+					DrawRectangle(enemies[i].position.x - healthBarWidth/2, enemies[i].position.y - enemies[i].radius - 15, 
+								  healthBarWidth, 8, GRAY);
+					DrawRectangle(enemies[i].position.x - healthBarWidth/2, enemies[i].position.y - enemies[i].radius - 15, 
+								  healthBarWidth * healthRatio, 8, GREEN);
 				}
 			}
-			
-			for (int i = 0; i < MAX_POWERUPS; i++) {
-				if (powerups[i].active) {
-					DrawCircleV(powerups[i].position, powerups[i].radius, powerups[i].color);
-					if (powerups[i].type == SHOTGUN_POWERUP) {
-						DrawText("S", powerups[i].position.x - 6, powerups[i].position.y - 10, 20, BLACK);
-					} else if (powerups[i].type == HEALTH_POWERUP) {
-						DrawText("H", powerups[i].position.x - 6, powerups[i].position.y - 10, 20, BLACK);
-					} else if (powerups[i].type == BOMB_POWERUP) {
-						DrawText("B", powerups[i].position.x - 6, powerups[i].position.y - 10, 20, BLACK);
-					}
+		}
+		
+		for (int i = 0; i < MAX_POWERUPS; i++) {
+			if (powerups[i].active) {
+				DrawCircleV(powerups[i].position, powerups[i].radius, powerups[i].color);
+				if (powerups[i].type == SHOTGUN_POWERUP) {
+					DrawText("S", powerups[i].position.x - 6, powerups[i].position.y - 10, 20, BLACK);
+				} else if (powerups[i].type == HEALTH_POWERUP) {
+					DrawText("H", powerups[i].position.x - 6, powerups[i].position.y - 10, 20, BLACK);
+				} else if (powerups[i].type == BOMB_POWERUP) {
+					DrawText("B", powerups[i].position.x - 6, powerups[i].position.y - 10, 20, BLACK);
+				} else if (powerups[i].type == HOMING_POWERUP) {
+					DrawText("M", powerups[i].position.x - 8, powerups[i].position.y - 10, 20, BLACK);
 				}
 			}
-			
-			if (bombEffect.active) {
-				DrawCircleLines(bombEffect.position.x, bombEffect.position.y, bombEffect.radius, Fade(RED, 0.5f));
+		}
+		
+		if (bombEffect.active) {
+			DrawCircleLines(bombEffect.position.x, bombEffect.position.y, bombEffect.radius, Fade(RED, 0.5f));
+		}
+		
+		DrawText(TextFormat("Score: %d", score), 50, 30, 24, WHITE);
+		
+		for (int i = 0; i < player.maxHealth; i++) {
+			Color heartColor = (i < player.health) ? RED : GRAY;
+			DrawCircle(80 + i * 50, 60, 12, heartColor);
+		}
+		
+		DrawText(TextFormat("Bombs: %d/%d", player.bombCount, player.maxBombs), 
+				 screenWidth - 250, 150, 24, RED);
+		DrawText(TextFormat("Bomb Damage: %d", player.bombDamage), 
+				 screenWidth - 250, 180, 24, RED);
+		
+		if (gameMode == TIMED_MODE) {
+			DrawText(TextFormat("Time: %.1f", gameTime), screenWidth - 250, 30, 24, WHITE);
+		} else {
+			DrawText("INFINITE MODE", screenWidth - 250, 30, 24, GREEN);
+			if (player.hasShotgun) {
+				DrawText(TextFormat("Shotgun: %.1f", player.shotgunTimer), screenWidth - 250, 60, 24, GREEN);
 			}
-			
-			DrawText(TextFormat("Score: %d", score), 50, 30, 24, WHITE);
-			
-			for (int i = 0; i < player.maxHealth; i++) {
-				Color heartColor = (i < player.health) ? RED : GRAY;
-				DrawCircle(80 + i * 50, 60, 12, heartColor);
+			if (player.hasHoming) {
+				DrawText(TextFormat("Missiles: %.1f", player.homingTimer), screenWidth - 250, 210, 24, PINK);
 			}
+			DrawText(TextFormat("Time: %d:%02d", (int)(minuteTimer/60), (int)minuteTimer%60), 
+					 screenWidth - 250, 90, 24, WHITE);
+			DrawText(TextFormat("Level: %d", level), screenWidth - 250, 120, 24, WHITE);
 			
-			DrawText(TextFormat("Bombs: %d/%d", player.bombCount, player.maxBombs), 
-					 screenWidth - 250, 150, 24, RED);
-			DrawText(TextFormat("Bomb Damage: %d", player.bombDamage), 
-					 screenWidth - 250, 180, 24, RED);
-			
-			if (gameMode == TIMED_MODE) {
-				DrawText(TextFormat("Time: %.1f", gameTime), screenWidth - 250, 30, 24, WHITE);
-			} else {
-				DrawText("INFINITE MODE", screenWidth - 250, 30, 24, GREEN);
-				if (player.hasShotgun) {
-					DrawText(TextFormat("Shotgun: %.1f", player.shotgunTimer), screenWidth - 250, 60, 24, GREEN);
-				}
-				DrawText(TextFormat("Time: %d:%02d", (int)(minuteTimer/60), (int)minuteTimer%60), 
-						 screenWidth - 250, 90, 24, WHITE);
-				DrawText(TextFormat("Level: %d", level), screenWidth - 250, 120, 24, WHITE);
-				
-				if (level % 5 == 0 && bossAlive) {
-					DrawText("BOSS FIGHT!", screenWidth/2 - MeasureText("BOSS FIGHT!", 36)/2, 50, 36, ORANGE);
-					DrawRectangleLinesEx(bossArea, 2.0f, Fade(ORANGE, 0.3f));
-				}
+			if (level % 5 == 0 && bossAlive) {
+				DrawText("BOSS FIGHT!", screenWidth/2 - MeasureText("BOSS FIGHT!", 36)/2, 50, 36, ORANGE);
+				DrawRectangleLinesEx(bossArea, 2.0f, Fade(ORANGE, 0.3f));
 			}
 		}
-		
-		switch (gameState) {
-		case MENU:
+	}
+	
+	switch (gameState) {
+	case MENU:
+		if (assets.hasFont) {
+			Vector2 titleSize = MeasureTextEx(assets.font, "PLANE SHOOTER GAME", 60, 2);
+			DrawTextEx(assets.font, "PLANE SHOOTER GAME", (Vector2){ screenWidth/2 - titleSize.x/2, 150 }, 60, 2, BLUE);
+		} else {
 			DrawText("PLANE SHOOTER GAME", 
 					 screenWidth/2 - MeasureText("PLANE SHOOTER GAME", 60)/2, 
 					 150, 60, BLUE);
-			DrawText("PRESS ENTER TO START", 
-					 screenWidth/2 - MeasureText("PRESS ENTER TO START", 30)/2, 
-					 250, 30, WHITE);
-			DrawText("H: HOW TO PLAY", 
-					 screenWidth/2 - MeasureText("H: HOW TO PLAY", 30)/2, 
-					 300, 30, WHITE);
-			DrawText("T: TIMED MODE (60 SECONDS)", 
-					 screenWidth/2 - MeasureText("T: TIMED MODE (60 SECONDS)", 30)/2, 
-					 350, 30, gameMode == TIMED_MODE ? GREEN : WHITE);
-			DrawText("I: INFINITE MODE (WITH POWERUPS & BOSSES)", 
-					 screenWidth/2 - MeasureText("I: INFINITE MODE (WITH POWERUPS & BOSSES)", 30)/2, 
-					 400, 30, gameMode == INFINITE_MODE ? GREEN : WHITE);
-			DrawText(TextFormat("TIMED HIGHSCORE: %d", highScores.timedModeHighScore), 
-					 screenWidth/2 - MeasureText(TextFormat("TIMED HIGHSCORE: %d", highScores.timedModeHighScore), 30)/2, 
-					 450, 30, YELLOW);
-			DrawText(TextFormat("INFINITE HIGHSCORE: %d", highScores.infiniteModeHighScore), 
-					 screenWidth/2 - MeasureText(TextFormat("INFINITE HIGHSCORE: %d", highScores.infiniteModeHighScore), 30)/2, 
-					 500, 30, YELLOW);
+		}
+		DrawText("PRESS ENTER TO START", 
+				 screenWidth/2 - MeasureText("PRESS ENTER TO START", 30)/2, 
+				 250, 30, WHITE);
+		DrawText("H: HOW TO PLAY", 
+				 screenWidth/2 - MeasureText("H: HOW TO PLAY", 30)/2, 
+				 300, 30, WHITE);
+		DrawText("T: TIMED MODE (60 SECONDS)", 
+				 screenWidth/2 - MeasureText("T: TIMED MODE (60 SECONDS)", 30)/2, 
+				 350, 30, gameMode == TIMED_MODE ? GREEN : WHITE);
+		DrawText("I: INFINITE MODE (WITH POWERUPS & BOSSES)", 
+				 screenWidth/2 - MeasureText("I: INFINITE MODE (WITH POWERUPS & BOSSES)", 30)/2, 
+				 400, 30, gameMode == INFINITE_MODE ? GREEN : WHITE);
+		DrawText(TextFormat("TIMED HIGHSCORE: %d", LeaderboardBest(&highScores.boards[TIMED_MODE])), 
+				 screenWidth/2 - MeasureText(TextFormat("TIMED HIGHSCORE: %d", LeaderboardBest(&highScores.boards[TIMED_MODE])), 30)/2, 
+				 450, 30, YELLOW);
+		DrawText(TextFormat("INFINITE HIGHSCORE: %d", LeaderboardBest(&highScores.boards[INFINITE_MODE])), 
+				 screenWidth/2 - MeasureText(TextFormat("INFINITE HIGHSCORE: %d", LeaderboardBest(&highScores.boards[INFINITE_MODE])), 30)/2, 
+				 500, 30, YELLOW);
+		
+		DrawText(gameMode == TIMED_MODE ? "TOP 5 - TIMED" : "TOP 5 - INFINITE", 40, 450, 24, YELLOW);
+		for (int i = 0; i < 5 && i < highScores.boards[gameMode].count; i++) {
+			const LeaderboardEntry *entry = &highScores.boards[gameMode].entries[i];
+			DrawText(TextFormat("%d. %6d  LV %d", i + 1, entry->score, entry->level), 40, 485 + i * 28, 22, WHITE);
+		}
+		
+		if (achievements.hobbyistAchieved) {
+			DrawText("ACHIEVEMENT: FLIGHT ENTHUSIAST", 
+					 screenWidth/2 - MeasureText("ACHIEVEMENT: FLIGHT ENTHUSIAST", 30)/2, 
+					 550, 30, GOLD);
+		}
+		if (achievements.pilotAchieved) {
+			DrawText("ACHIEVEMENT: ACE PILOT", 
+					 screenWidth/2 - MeasureText("ACHIEVEMENT: ACE PILOT", 30)/2, 
+					 580, 30, GOLD);
+		}
+		break;
+		
+	case INSTRUCTIONS:
+		DrawInstructionsScreen(screenWidth, screenHeight);
+		break;
+		
+	case PAUSED:
+		DrawText("GAME PAUSED", 
+				 screenWidth/2 - MeasureText("GAME PAUSED", 40)/2, 
+				 screenHeight/2 - 100, 40, BLUE);
+		DrawText("PRESS P TO CONTINUE", 
+				 screenWidth/2 - MeasureText("PRESS P TO CONTINUE", 30)/2, 
+				 screenHeight/2 - 50, 30, WHITE);
+		DrawText("PRESS R TO RETURN TO MENU", 
+				 screenWidth/2 - MeasureText("PRESS R TO RETURN TO MENU", 30)/2, 
+				 screenHeight/2 + 20, 30, WHITE);
+		break;
+		
+	case GAME_OVER:
+		DrawText("GAME OVER", 
+				 screenWidth/2 - MeasureText("GAME OVER", 40)/2, 
+				 screenHeight/2 - 100, 40, RED);
+		DrawText(TextFormat("YOUR SCORE: %d", score), 
+				 screenWidth/2 - MeasureText(TextFormat("YOUR SCORE: %d", score), 30)/2, 
+				 screenHeight/2 - 50, 30, WHITE);
+		if (gameMode == INFINITE_MODE) {
+			DrawText(TextFormat("HIGHSCORE: %d", LeaderboardBest(&highScores.boards[INFINITE_MODE])), 
+					 screenWidth/2 - MeasureText(TextFormat("HIGHSCORE: %d", LeaderboardBest(&highScores.boards[INFINITE_MODE])), 30)/2, 
+					 screenHeight/2 - 10, 30, YELLOW);
+			DrawText(TextFormat("LEVEL REACHED: %d", level), 
+					 screenWidth/2 - MeasureText(TextFormat("LEVEL REACHED: %d", level), 25)/2, 
+					 screenHeight/2 + 30, 25, WHITE);
 			
-			if (achievements.hobbyistAchieved) {
-				DrawText("ACHIEVEMENT: FLIGHT ENTHUSIAST", 
-						 screenWidth/2 - MeasureText("ACHIEVEMENT: FLIGHT ENTHUSIAST", 30)/2, 
-						 550, 30, GOLD);
-			}
 			if (achievements.pilotAchieved) {
-				DrawText("ACHIEVEMENT: ACE PILOT", 
-						 screenWidth/2 - MeasureText("ACHIEVEMENT: ACE PILOT", 30)/2, 
-						 580, 30, GOLD);
+				DrawText("ACE PILOT ACHIEVED!", 
+						 screenWidth/2 - MeasureText("ACE PILOT ACHIEVED!", 30)/2, 
+						 screenHeight/2 + 60, 30, GOLD);
 			}
-			break;
+		} else {
+			DrawText(TextFormat("HIGHSCORE: %d", LeaderboardBest(&highScores.boards[TIMED_MODE])), 
+					 screenWidth/2 - MeasureText(TextFormat("HIGHSCORE: %d", LeaderboardBest(&highScores.boards[TIMED_MODE])), 30)/2, 
+					 screenHeight/2 - 10, 30, YELLOW);
+		}
+		if (leaderboardRank >= 0) {
+			DrawText(TextFormat("NEW #%d ON THE LEADERBOARD!", leaderboardRank + 1), 
+					 screenWidth/2 - MeasureText(TextFormat("NEW #%d ON THE LEADERBOARD!", leaderboardRank + 1), 25)/2, 
+					 screenHeight/2 - 150, 25, GOLD);
+		}
+		DrawText("PRESS R TO RETURN TO MENU", 
+				 screenWidth/2 - MeasureText("PRESS R TO RETURN TO MENU", 20)/2, 
+				 screenHeight/2 + 100, 20, WHITE);
+		break;
+		
+	case TIME_UP:
+		DrawText("TIME'S UP!", 
+				 screenWidth/2 - MeasureText("TIME'S UP!", 40)/2, 
+				 screenHeight/2 - 100, 40, GREEN);
+		DrawText(TextFormat("YOUR SCORE: %d", score), 
+				 screenWidth/2 - MeasureText(TextFormat("YOUR SCORE: %d", score), 30)/2, 
+				 screenHeight/2 - 50, 30, WHITE);
+		DrawText(TextFormat("HIGHSCORE: %d", LeaderboardBest(&highScores.boards[TIMED_MODE])), 
+				 screenWidth/2 - MeasureText(TextFormat("HIGHSCORE: %d", LeaderboardBest(&highScores.boards[TIMED_MODE])), 30)/2, 
+				 screenHeight/2 - 10, 30, YELLOW);
+		if (leaderboardRank >= 0) {
+			DrawText(TextFormat("NEW #%d ON THE LEADERBOARD!", leaderboardRank + 1), 
+					 screenWidth/2 - MeasureText(TextFormat("NEW #%d ON THE LEADERBOARD!", leaderboardRank + 1), 25)/2, 
+					 screenHeight/2 - 150, 25, GOLD);
+		}
+		DrawText("PRESS R TO RETURN TO MENU", 
+				 screenWidth/2 - MeasureText("PRESS R TO RETURN TO MENU", 20)/2, 
+				 screenHeight/2 + 30, 20, WHITE);
+		break;
+	}
+	
+	if (showProfiler) {
+		DrawProfiler();
+	}
+}
+
+static double BenchNow(void) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int LinearNearest(const Vector2 *points, int count, Vector2 target) {
+	int best = -1;
+	float bestDistanceSq = 0.0f;
+	for (int i = 0; i < count; i++) {
+		float distanceSq = KdDistanceSq(points[i], target);
+		if (best < 0 || distanceSq < bestDistanceSq) {
+			best = i;
+			bestDistanceSq = distanceSq;
+		}
+	}
+	return best;
+}
+
+static int LinearRadius(const Vector2 *points, int count, Vector2 target, float radius, int *out) {
+	int found = 0;
+	for (int i = 0; i < count; i++) {
+		out[found] = i;
+		found += KdDistanceSq(points[i], target) < radius*radius;
+	}
+	return found;
+}
+
+// Missile retargeting at scale: per tick, rebuild the tree over N targets and
+// answer one nearest query per missile, against the linear scan it replaces.
+// Also times 4-nearest and bomb-sized radius queries, and checks the tree
+// against the scan.
+static void BenchmarkTargeting(void) {
+	static const int targetCounts[] = { MAX_ENEMIES, 64, 256, KD_MAX_POINTS };
+	static Vector2 targets[KD_MAX_POINTS];
+	static Vector2 probes[BENCH_TARGET_QUERIES];
+	static KdTree tree;
+	
+	printf("  targeting, %d queries per tick, %d ticks per size:\n", BENCH_TARGET_QUERIES, BENCH_TARGET_ROUNDS);
+	for (size_t c = 0; c < sizeof(targetCounts)/sizeof(targetCounts[0]); c++) {
+		int count = targetCounts[c];
+		SetRandomSeed(BENCH_SEED + count);
+		for (int i = 0; i < count; i++) {
+			targets[i] = (Vector2){ (float)GetRandomValue(0, screenWidth), (float)GetRandomValue(0, screenHeight) };
+		}
+		for (int i = 0; i < BENCH_TARGET_QUERIES; i++) {
+			probes[i] = (Vector2){ (float)GetRandomValue(0, screenWidth), (float)GetRandomValue(0, screenHeight) };
+		}
+		
+		double buildSeconds = 0.0;
+		double nearestSeconds = 0.0;
+		double kNearestSeconds = 0.0;
+		double radiusSeconds = 0.0;
+		double linearSeconds = 0.0;
+		double linearRadiusSeconds = 0.0;
+		int mismatches = 0;
+		long long checksum = 0;
+		tree.visited = 0;
+		
+		for (int round = 0; round < BENCH_TARGET_ROUNDS; round++) {
+			double start = BenchNow();
+			ResetKdTree(&tree);
+			for (int i = 0; i < count; i++) {
+				KdTreeAdd(&tree, targets[i], i);
+			}
+			BuildKdTree(&tree);
+			buildSeconds += BenchNow() - start;
 			
-		case INSTRUCTIONS:
-			DrawInstructionsScreen(screenWidth, screenHeight);
-			break;
+			int kdFound[BENCH_TARGET_QUERIES];
+			start = BenchNow();
+			for (int q = 0; q < BENCH_TARGET_QUERIES; q++) {
+				kdFound[q] = KdNearest(&tree, probes[q]);
+			}
+			nearestSeconds += BenchNow() - start;
 			
-		case PAUSED:
-			DrawText("GAME PAUSED", 
-					 screenWidth/2 - MeasureText("GAME PAUSED", 40)/2, 
-					 screenHeight/2 - 100, 40, BLUE);
-			DrawText("PRESS P TO CONTINUE", 
-					 screenWidth/2 - MeasureText("PRESS P TO CONTINUE", 30)/2, 
-					 screenHeight/2 - 50, 30, WHITE);
-			DrawText("PRESS R TO RETURN TO MENU", 
-					 screenWidth/2 - MeasureText("PRESS R TO RETURN TO MENU", 30)/2, 
-					 screenHeight/2 + 20, 30, WHITE);
-			break;
+			int linearFound[BENCH_TARGET_QUERIES];
+			start = BenchNow();
+			for (int q = 0; q < BENCH_TARGET_QUERIES; q++) {
+				linearFound[q] = LinearNearest(targets, count, probes[q]);
+			}
+			linearSeconds += BenchNow() - start;
 			
-		case GAME_OVER:
-			DrawText("GAME OVER", 
-					 screenWidth/2 - MeasureText("GAME OVER", 40)/2, 
-					 screenHeight/2 - 100, 40, RED);
-			DrawText(TextFormat("YOUR SCORE: %d", score), 
-					 screenWidth/2 - MeasureText(TextFormat("YOUR SCORE: %d", score), 30)/2, 
-					 screenHeight/2 - 50, 30, WHITE);
-			if (gameMode == INFINITE_MODE) {
-				DrawText(TextFormat("HIGHSCORE: %d", highScores.infiniteModeHighScore), 
-						 screenWidth/2 - MeasureText(TextFormat("HIGHSCORE: %d", highScores.infiniteModeHighScore), 30)/2, 
-						 screenHeight/2 - 10, 30, YELLOW);
-				DrawText(TextFormat("LEVEL REACHED: %d", level), 
-						 screenWidth/2 - MeasureText(TextFormat("LEVEL REACHED: %d", level), 25)/2, 
-						 screenHeight/2 + 30, 25, WHITE);
-				
-				if (achievements.pilotAchieved) {
-					DrawText("ACE PILOT ACHIEVED!", 
-							 screenWidth/2 - MeasureText("ACE PILOT ACHIEVED!", 30)/2, 
-							 screenHeight/2 + 60, 30, GOLD);
+			KdResult nearest[4];
+			start = BenchNow();
+			for (int q = 0; q < BENCH_TARGET_QUERIES; q++) {
+				checksum += KdKNearest(&tree, probes[q], 4, nearest);
+			}
+			kNearestSeconds += BenchNow() - start;
+			
+			int caught[KD_MAX_POINTS];
+			int kdRadiusTotal = 0;
+			int linearRadiusTotal = 0;
+			start = BenchNow();
+			for (int q = 0; q < BENCH_TARGET_QUERIES; q++) {
+				kdRadiusTotal += KdRadius(&tree, probes[q], BOMB_RADIUS, caught, KD_MAX_POINTS);
+			}
+			radiusSeconds += BenchNow() - start;
+			start = BenchNow();
+			for (int q = 0; q < BENCH_TARGET_QUERIES; q++) {
+				linearRadiusTotal += LinearRadius(targets, count, probes[q], BOMB_RADIUS, caught);
+			}
+			linearRadiusSeconds += BenchNow() - start;
+			
+			// Ties may pick different targets, so compare distances
+			for (int q = 0; q < BENCH_TARGET_QUERIES; q++) {
+				if (KdDistanceSq(targets[kdFound[q]], probes[q]) != KdDistanceSq(targets[linearFound[q]], probes[q])) {
+					mismatches++;
 				}
+			}
+			mismatches += (kdRadiusTotal != linearRadiusTotal);
+			checksum += kdRadiusTotal;
+		}
+		
+		double queries = (double)BENCH_TARGET_QUERIES * BENCH_TARGET_ROUNDS;
+		printf("    N=%4d: build %6.2f us | nearest %5.0f ns (linear %5.0f ns, %4.1fx) | 4-nearest %5.0f ns | "
+			   "radius %5.0f ns (linear %5.0f ns) | %.1f nodes/query, %d mismatches\n", 
+			   count, buildSeconds * 1e6 / BENCH_TARGET_ROUNDS, nearestSeconds * 1e9 / queries, 
+			   linearSeconds * 1e9 / queries, linearSeconds / nearestSeconds, kNearestSeconds * 1e9 / queries, 
+			   radiusSeconds * 1e9 / queries, linearRadiusSeconds * 1e9 / queries, 
+			   tree.visited / (queries * 3), mismatches);
+		if (checksum == 0) {
+			printf("      (no results)\n");
+		}
+	}
+}
+
+// Per-record cost of telemetry, timed over the same mapping the scripted run
+// wrote to, and what the run's record rate makes of it per frame.
+static void BenchmarkTelemetry(uint64_t runRecords, int ticks) {
+	if (!telemetry.session) {
+		printf("  telemetry: could not map %s\n", BENCH_TELEMETRY_FILE);
+		return;
+	}
+	double start = BenchNow();
+	for (int i = 0; i < BENCH_TELEMETRY_RECORDS; i++) {
+		TelemetryWrite(&telemetry, TELEMETRY_FRAME, 0, (float)i, i, level);
+	}
+	double nsPerRecord = (BenchNow() - start) * 1e9 / BENCH_TELEMETRY_RECORDS;
+	double recordsPerTick = (double)runRecords / ticks;
+	printf("  telemetry: %.1f ns/record, %.2f records/tick -> %.1f ns/tick, %.5f%% of a %.1f ms frame\n", nsPerRecord, 
+		   recordsPerTick, nsPerRecord * recordsPerTick, nsPerRecord * recordsPerTick / (1e9 / TARGET_FPS) * 100.0, 
+		   1000.0 / TARGET_FPS);
+}
+
+// Charges each simulation phase with the entities live at the start of the tick.
+static void CountPhaseEntities(void) {
+	int liveBullets = 0;
+	int liveEnemies = 0;
+	int livePowerups = 0;
+	for (int i = 0; i < MAX_BULLETS; i++) {
+		liveBullets += bullets[i].active;
+	}
+	for (int i = 0; i < MAX_ENEMIES; i++) {
+		liveEnemies += enemies[i].active;
+	}
+	for (int i = 0; i < MAX_POWERUPS; i++) {
+		livePowerups += powerups[i].active;
+	}
+	simPhases[SIM_PHASE_BULLETS].entityTicks += liveBullets;
+	simPhases[SIM_PHASE_ENEMIES].entityTicks += liveEnemies;
+	simPhases[SIM_PHASE_COLLISIONS].entityTicks += liveBullets + liveEnemies + livePowerups;
+}
+
+static void PrintSimPhases(void) {
+	for (int i = 0; i < SIM_PHASE_COUNT; i++) {
+		PrintPerfPhase(&perfCounters, &simPhases[i]);
+	}
+	for (int i = 0; i < SIM_PHASE_COUNT; i++) {
+		ResetPerfPhase(&simPhases[i]);
+	}
+}
+
+// Tops the field up to a fixed population: enemies (every fourth an elite
+// running its behaviour) appear in the upper half and drift down, player
+// bullets rise from the lower half. Seeded, so the same ticks replay every run.
+static void StockWorkload(int bulletCount, int enemyCount) {
+	int live = 0;
+	for (int i = 0; i < MAX_ENEMIES; i++) {
+		live += enemies[i].active;
+	}
+	for (int i = 0; i < MAX_ENEMIES && live < enemyCount; i++) {
+		if (!enemies[i].active) {
+			bool elite = (i % 4 == 3);
+			enemies[i].position = (Vector2){ 
+				(float)GetRandomValue(50, screenWidth - 50), 
+				(float)GetRandomValue(-30, screenHeight/2) 
+			};
+			enemies[i].speed = (Vector2){ 0, (float)GetRandomValue(1, 3) };
+			enemies[i].radius = elite ? 22 : 20;
+			enemies[i].active = true;
+			enemies[i].color = elite ? PURPLE : RED;
+			enemies[i].type = elite ? ELITE_ENEMY : NORMAL_ENEMY;
+			enemies[i].health = 3;
+			enemies[i].maxHealth = 3;
+			enemies[i].scoreValue = 10;
+			if (elite) {
+				StartBehaviour(&enemies[i].behaviour, EliteBehaviour(&enemies[i]));
 			} else {
-				DrawText(TextFormat("HIGHSCORE: %d", highScores.timedModeHighScore), 
-						 screenWidth/2 - MeasureText(TextFormat("HIGHSCORE: %d", highScores.timedModeHighScore), 30)/2, 
-						 screenHeight/2 - 10, 30, YELLOW);
+				ReleaseBehaviour(&enemies[i].behaviour);
 			}
-			DrawText("PRESS R TO RETURN TO MENU", 
-					 screenWidth/2 - MeasureText("PRESS R TO RETURN TO MENU", 20)/2, 
-					 screenHeight/2 + 100, 20, WHITE);
-			break;
+			live++;
+		}
+	}
+	
+	live = 0;
+	for (int i = 0; i < MAX_BULLETS; i++) {
+		live += bullets[i].active;
+	}
+	for (int i = 0; i < MAX_BULLETS && live < bulletCount; i++) {
+		if (!bullets[i].active) {
+			bullets[i].position = (Vector2){ 
+				(float)GetRandomValue(0, screenWidth), 
+				(float)GetRandomValue(screenHeight/2, screenHeight) 
+			};
+			bullets[i].speed = (Vector2){ 0, -12 };
+			bullets[i].radius = 6;
+			bullets[i].active = true;
+			bullets[i].color = YELLOW;
+			bullets[i].isPlayerBullet = true;
+			bullets[i].homing = false;
+			live++;
+		}
+	}
+}
+
+// Per-phase cost of UpdateGame at several fixed entity counts, up to the
+// pool capacities.
+static void BenchmarkPhases(void) {
+	static const struct {
+		int bullets;
+		int enemies;
+	} workloads[] = {
+		{ 25, 4 },
+		{ 50, 8 },
+		{ 100, 12 },
+		{ MAX_BULLETS, MAX_ENEMIES },
+	};
+	const float dt = 1.0f/60.0f;
+	
+	printf("  fixed workloads, %d ticks each, per entity per tick:\n", BENCH_PHASE_TICKS);
+	for (size_t w = 0; w < sizeof(workloads)/sizeof(workloads[0]); w++) {
+		SetRandomSeed(BENCH_SEED + w);
+		gameMode = INFINITE_MODE;
+		StartGame();
+		gameState = PLAYING;
+		
+		for (int tick = 0; tick < BENCH_PHASE_TICKS; tick++) {
+			player.health = player.maxHealth;
+			StockWorkload(workloads[w].bullets, workloads[w].enemies);
+			CountPhaseEntities();
 			
-		case TIME_UP:
-			DrawText("TIME'S UP!", 
-					 screenWidth/2 - MeasureText("TIME'S UP!", 40)/2, 
-					 screenHeight/2 - 100, 40, GREEN);
-			DrawText(TextFormat("YOUR SCORE: %d", score), 
-					 screenWidth/2 - MeasureText(TextFormat("YOUR SCORE: %d", score), 30)/2, 
-					 screenHeight/2 - 50, 30, WHITE);
-			DrawText(TextFormat("HIGHSCORE: %d", highScores.timedModeHighScore), 
-					 screenWidth/2 - MeasureText(TextFormat("HIGHSCORE: %d", highScores.timedModeHighScore), 30)/2, 
-					 screenHeight/2 - 10, 30, YELLOW);
-			DrawText("PRESS R TO RETURN TO MENU", 
-					 screenWidth/2 - MeasureText("PRESS R TO RETURN TO MENU", 20)/2, 
-					 screenHeight/2 + 30, 20, WHITE);
-			break;
+			double tickStart = BenchNow();
+			UpdateGame(dt);
+			frameSimMs = (float)((BenchNow() - tickStart) * 1000.0);
+			gameState = PLAYING;
+		}
+		printf("    %d bullets, %d enemies:\n", workloads[w].bullets, workloads[w].enemies);
+		PrintSimPhases();
+	}
+}
+
+// Runs the simulation without a window. An invulnerable scripted pilot sweeps
+// the screen firing on a fixed cadence in infinite mode, starting on a boss
+// level so every behaviour script gets exercised. Same seed, same workload.
+// Audio runs on the null backend and is mixed by hand, a tick's worth of
+// frames at a time, so its cost is measured separately from the update.
+// Telemetry goes to a scratch ring that is deleted afterwards.
+// The update is also split into phases, with hardware counters when
+// `hardwareCounters` is set and the system allows them.
+static int RunBenchmark(int ticks, bool hardwareCounters) {
+	const float dt = 1.0f/60.0f;
+	
+	OpenPerfCounters(&perfCounters, hardwareCounters);
+	InitAudioMixer(&audio, AUDIO_BACKEND_NULL, NULL);
+	SetRandomSeed(BENCH_SEED);
+	gameMode = INFINITE_MODE;
+	StartGame();
+	gameState = PLAYING;
+	level = 5;
+	TelemetryOpen(&telemetry, BENCH_TELEMETRY_FILE);
+	TelemetryBeginSession(&telemetry, gameMode);
+	uint64_t firstRecord = telemetry.header ? telemetry.header->head : 0;
+	
+	double updateSeconds = 0.0;
+	double mixSeconds = 0.0;
+	float audioFrames = 0.0f;
+	for (int tick = 0; tick < ticks; tick++) {
+		player.health = player.maxHealth;
+		player.position.x = screenWidth/2 + sinf(tick * 0.02f) * (screenWidth/2 - 100);
+		if (tick % 8 == 0) {
+			PushInputEvent(&input, KEY_SPACE, tick * dt);
+		}
+		
+		CountPhaseEntities();
+		double tickStart = BenchNow();
+		UpdateGame(dt);
+		double tickSeconds = BenchNow() - tickStart;
+		
+		updateSeconds += tickSeconds;
+		frameSimMs = (float)(tickSeconds * 1000.0);
+		gameState = PLAYING;
+		
+		for (int i = 0; i < BENCH_SFX_STORM; i++) {
+			PlaySfx(&audio, SFX_SHOT, (float)i / BENCH_SFX_STORM);
+		}
+		double mixStart = BenchNow();
+		for (audioFrames += AUDIO_SAMPLE_RATE * dt; audioFrames >= AUDIO_BLOCK_FRAMES; audioFrames -= AUDIO_BLOCK_FRAMES) {
+			MixAudioBlock(&audio);
 		}
+		mixSeconds += BenchNow() - mixStart;
+	}
+	
+	AudioStats audioStats = GetAudioStats(&audio);
+	uint64_t runRecords = telemetry.header ? telemetry.header->head - firstRecord : 0;
+	
+	double simulatedSeconds = ticks * dt;
+	printf("Headless benchmark: %d ticks (%.0f s simulated), seed %d\n", ticks, simulatedSeconds, BENCH_SEED);
+	printf("  update: %.1f ms total, %.2f us/tick\n", updateSeconds * 1000.0, updateSeconds * 1e6 / ticks);
+	printf("  behaviour resumes: %llu (%.1f per simulated second, %.0f per wall second)\n", 
+		   (unsigned long long)behaviourArena.resumes, behaviourArena.resumes / simulatedSeconds, 
+		   behaviourArena.resumes / updateSeconds);
+	printf("  coroutine arena: peak %d/%d blocks, largest frame %zu/%d bytes, %d failed allocations\n", 
+		   behaviourArena.peakInUse, BEHAVIOUR_ARENA_BLOCKS, behaviourArena.largestFrame, 
+		   BEHAVIOUR_BLOCK_SIZE, behaviourArena.failedAllocs);
+	printf("  audio (%s mixer): %llu blocks, %.2f us/block, %.2f us/tick\n", AUDIO_SIMD ? "SSE" : "scalar", 
+		   (unsigned long long)audioStats.blocks, mixSeconds * 1e6 / audioStats.blocks, mixSeconds * 1e6 / ticks);
+	printf("  sfx: %d requested, %d rate-limited, %d stolen, %d dropped, peak %d/%d voices\n", audioStats.requested, 
+		   audioStats.rateLimited, audioStats.stolen, audioStats.dropped, audioStats.peakVoices, AUDIO_VOICES);
+	printf("  reached level %d, score %d, director density %.2f\n", level, score, director.density);
+	BenchmarkTelemetry(runRecords, ticks);
+	TelemetryClose(&telemetry);
+	remove(BENCH_TELEMETRY_FILE);
+	BenchmarkTargeting();
+	
+	if (perfCounters.available) {
+		printf("  simulation phases (user-space counters):\n");
+	} else {
+		printf("  simulation phases (timing only, %s):\n", perfCounters.error);
+	}
+	printf("    scripted run above:\n");
+	PrintSimPhases();
+	BenchmarkPhases();
+	if (perfCounters.available && perfCounters.timeRunning < perfCounters.timeEnabled) {
+		printf("  counters were multiplexed (scheduled %.0f%% of the time), so they undercount\n", 
+			   100.0 * perfCounters.timeRunning / perfCounters.timeEnabled);
+	}
+	
+	ClosePerfCounters(&perfCounters);
+	CloseAudioMixer(&audio);
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	const double processStart = BenchNow();
+	InitBehaviourArena();
+	
+	// --bench [ticks] [--perf]
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+		int ticks = BENCH_TICKS;
+		bool hardwareCounters = false;
+		for (int i = 2; i < argc; i++) {
+			if (strcmp(argv[i], "--perf") == 0) {
+				hardwareCounters = true;
+			} else {
+				ticks = atoi(argv[i]);
+			}
+		}
+		return RunBenchmark(ticks, hardwareCounters);
+	}
+	
+	// --audio-null runs without a sound device, --audio-file <path> records to a WAV
+	AudioBackend audioBackend = AUDIO_BACKEND_DEVICE;
+	const char *audioFile = NULL;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--audio-null") == 0) {
+			audioBackend = AUDIO_BACKEND_NULL;
+		} else if (strcmp(argv[i], "--audio-file") == 0 && i + 1 < argc) {
+			audioBackend = AUDIO_BACKEND_FILE;
+			audioFile = argv[++i];
+		}
+	}
+	
+	InitWindow(screenWidth, screenHeight, "Plane Shooter Game");
+	
+	// Optional: without the archive everything is drawn from primitives
+	LoadAssetArchive(&assets, ASSET_ARCHIVE_FILE);
+	LoadStarfield(&starfield, STARFIELD_SEED);
+	InitAudioMixer(&audio, audioBackend, audioFile);
+	StartAudioMixer(&audio);
+	TelemetryOpen(&telemetry, TELEMETRY_FILE);
+	LoadProgress(&highScores, &achievements);
+	ProfileSaverStart(&profileSaver);
+	ResetDirector(&director);
+	
+	// Frames are paced by hand instead of SetTargetFPS() so we control where
+	// the wait happens relative to input sampling.
+	const double framePeriod = 1.0 / TARGET_FPS;
+	double frameDeadline = GetTime() + framePeriod;
+	double frameWork = 0.0;
+	
+	while (!WindowShouldClose()) {
+		if (lowLatencyPacing) {
+			// Wait first and sample input as late as possible, so the tick
+			// presents just before the deadline with the freshest input.
+			WaitSamplingInput(&input, frameDeadline - frameWork - LOW_LATENCY_MARGIN);
+			PollInputEvents();
+			CollectInputEvents(&input, GetTime());
+		}
+		
+		double frameStart = GetTime();
+		TelemetryBeginFrame(&telemetry, frameStart);
+		
+		UpdateGame(GetFrameTime());
+		double updateEnd = GetTime();
+		
+		BeginDrawing();
+		DrawGame();
+		double drawEnd = GetTime();
+		CaptureFrame(&capture, drawEnd);
 		EndDrawing();
+		double presentTime = GetTime();
+		CollectInputEvents(&input, presentTime);
+		
+		if (startupMs == 0.0f) {
+			startupMs = (float)((BenchNow() - processStart) * 1000.0);
+			TraceLog(LOG_INFO, "STARTUP: first menu frame after %.1f ms (asset archive %.2f ms)", startupMs, assets.loadMs);
+		}
+		
+		for (int i = 0; i < input.tickCount; i++) {
+			float latencyMs = (float)((presentTime - input.tick[i].time) * 1000.0);
+			RecordLatency(&inputLatency, latencyMs);
+			TelemetryWrite(&telemetry, TELEMETRY_INPUT_LATENCY, lowLatencyPacing, latencyMs, input.tick[i].key, 0);
+		}
+		
+		// Measured CPU cost feeds the spawn director on the next tick
+		frameSimMs = (float)((updateEnd - frameStart) * 1000.0);
+		frameDrawMs = (float)((drawEnd - updateEnd) * 1000.0);
+		frameWork += ((presentTime - frameStart) - frameWork) * 0.1;
+		
+		if (!lowLatencyPacing) {
+			// Classic pacing: present, then sleep out the rest of the frame
+			WaitSamplingInput(&input, frameDeadline);
+		}
+		frameDeadline += framePeriod;
+		if (frameDeadline < GetTime()) {
+			frameDeadline = GetTime() + framePeriod;
+		}
 	}
 	
+	TelemetryEndSession(&telemetry, gameMode, score, level);
+	TelemetryClose(&telemetry);
+	ProfileSaverStop(&profileSaver);
+	
+	StopCapture(&capture);
+	CloseAudioMixer(&audio);
+	UnloadStarfield(&starfield);
+	UnloadAssetArchive(&assets);
 	CloseWindow();
 	return 0;
 }
@@ -0,0 +1,188 @@
+#ifndef ASSET_ARCHIVE_H
+#define ASSET_ARCHIVE_H
+
+// Packed sprite archive built offline by asset_packer.
+//
+// Layout: AssetArchiveHeader, AssetSprite table, AssetGlyph table, then the
+// atlas pixels already in the GPU upload format (RGBA8, top row first). The
+// game maps the file, points an Image at the pixels and uploads the whole atlas
+// with a single LoadTextureFromImage() - no per-file decode, no copy.
+//
+// Sprites are sorted by group then frame, so the frames of one enemy type are a
+// contiguous run of the table.
+
+#include <string.h>
+#include "raylib.h"
+#include "file_map.h"
+
+#define ASSET_ARCHIVE_MAGIC 0x4B415041u // "APAK"
+#define ASSET_ARCHIVE_VERSION 1
+#define ASSET_ARCHIVE_FILE "assets.pak"
+#define ASSET_NAME_LENGTH 32
+#define ASSET_DATA_ALIGNMENT 64
+
+typedef enum {
+	ASSET_GROUP_MISC,
+	ASSET_GROUP_PLAYER,
+	ASSET_GROUP_ENEMY_NORMAL,		// followed by one group per EnemyType
+	ASSET_GROUP_ENEMY_ELITE,
+	ASSET_GROUP_ENEMY_BOSS,
+	ASSET_GROUP_EFFECT,
+	ASSET_GROUP_COUNT
+} AssetGroup;
+
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t headerSize;
+	uint32_t atlasWidth;
+	uint32_t atlasHeight;
+	uint32_t pixelFormat;		// raylib PixelFormat
+	uint32_t pixelOffset;
+	uint32_t pixelSize;
+	uint32_t spriteCount;
+	uint32_t spriteOffset;
+	uint32_t glyphCount;
+	uint32_t glyphOffset;
+	int32_t fontBaseSize;		// 0 when the archive has no font
+	uint32_t reserved[4];
+} AssetArchiveHeader;
+
+typedef struct {
+	char name[ASSET_NAME_LENGTH];	// source file name without extension
+	float x;
+	float y;
+	float width;
+	float height;
+	int16_t group;					// AssetGroup
+	int16_t frame;
+	uint32_t reserved;
+} AssetSprite;
+
+typedef struct {
+	int32_t value;					// codepoint
+	int32_t offsetX;
+	int32_t offsetY;
+	int32_t advanceX;
+	float x;
+	float y;
+	float width;
+	float height;
+} AssetGlyph;
+
+static_assert(sizeof(AssetArchiveHeader) == 64, "asset archive header layout changed");
+static_assert(sizeof(AssetSprite) == 56, "asset sprite layout changed");
+static_assert(sizeof(AssetGlyph) == 32, "asset glyph layout changed");
+
+typedef struct {
+	bool loaded;
+	Texture2D atlas;
+	AssetSprite *sprites;
+	int spriteCount;
+	int groupStart[ASSET_GROUP_COUNT];
+	int groupFrames[ASSET_GROUP_COUNT];
+	bool hasFont;
+	Font font;
+	float loadMs;
+} AssetArchive;
+
+static inline bool ValidateAssetArchive(const MappedFile *file) {
+	const AssetArchiveHeader *header = (const AssetArchiveHeader *)file->data;
+	if (file->size < sizeof(AssetArchiveHeader) || header->magic != ASSET_ARCHIVE_MAGIC ||
+		header->version != ASSET_ARCHIVE_VERSION || header->headerSize != sizeof(AssetArchiveHeader) ||
+		header->pixelFormat != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+		return false;
+	}
+	uint64_t spriteEnd = header->spriteOffset + (uint64_t)header->spriteCount * sizeof(AssetSprite);
+	uint64_t glyphEnd = header->glyphOffset + (uint64_t)header->glyphCount * sizeof(AssetGlyph);
+	uint64_t pixelEnd = header->pixelOffset + (uint64_t)header->pixelSize;
+	return spriteEnd <= file->size && glyphEnd <= file->size && pixelEnd <= file->size &&
+		   header->pixelSize == (uint64_t)header->atlasWidth * header->atlasHeight * 4;
+}
+
+// Needs a window (GL context). Leaves `archive->loaded` false if the file is
+// missing or invalid, in which case the game keeps drawing primitives.
+static inline bool LoadAssetArchive(AssetArchive *archive, const char *path) {
+	double start = GetTime();
+	memset(archive, 0, sizeof(*archive));
+	
+	MappedFile file;
+	if (!MapFileRead(&file, path)) {
+		return false;
+	}
+	if (!ValidateAssetArchive(&file)) {
+		TraceLog(LOG_WARNING, "ASSETS: %s is not a version %d archive", path, ASSET_ARCHIVE_VERSION);
+		UnmapFile(&file);
+		return false;
+	}
+	
+	const unsigned char *base = (const unsigned char *)file.data;
+	const AssetArchiveHeader *header = (const AssetArchiveHeader *)base;
+	
+	Image atlas = {
+		.data = (void *)(base + header->pixelOffset),
+		.width = (int)header->atlasWidth,
+		.height = (int)header->atlasHeight,
+		.mipmaps = 1,
+		.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8
+	};
+	archive->atlas = LoadTextureFromImage(atlas);
+	
+	archive->spriteCount = (int)header->spriteCount;
+	archive->sprites = (AssetSprite *)MemAlloc(header->spriteCount * sizeof(AssetSprite) + 1);
+	memcpy(archive->sprites, base + header->spriteOffset, header->spriteCount * sizeof(AssetSprite));
+	for (int i = archive->spriteCount - 1; i >= 0; i--) {
+		int group = archive->sprites[i].group;
+		if (group >= 0 && group < ASSET_GROUP_COUNT) {
+			archive->groupStart[group] = i;
+			archive->groupFrames[group]++;
+		}
+	}
+	
+	if (header->glyphCount > 0) {
+		const AssetGlyph *glyphs = (const AssetGlyph *)(base + header->glyphOffset);
+		archive->font.baseSize = header->fontBaseSize;
+		archive->font.glyphCount = (int)header->glyphCount;
+		archive->font.glyphPadding = 0;
+		archive->font.texture = archive->atlas;
+		archive->font.recs = (Rectangle *)MemAlloc(header->glyphCount * sizeof(Rectangle));
+		archive->font.glyphs = (GlyphInfo *)MemAlloc(header->glyphCount * sizeof(GlyphInfo));
+		for (uint32_t i = 0; i < header->glyphCount; i++) {
+			archive->font.recs[i] = (Rectangle){ glyphs[i].x, glyphs[i].y, glyphs[i].width, glyphs[i].height };
+			archive->font.glyphs[i].value = glyphs[i].value;
+			archive->font.glyphs[i].offsetX = glyphs[i].offsetX;
+			archive->font.glyphs[i].offsetY = glyphs[i].offsetY;
+			archive->font.glyphs[i].advanceX = glyphs[i].advanceX;
+		}
+		archive->hasFont = true;
+	}
+	
+	UnmapFile(&file);
+	archive->loaded = archive->atlas.id != 0;
+	archive->loadMs = (float)((GetTime() - start) * 1000.0);
+	TraceLog(LOG_INFO, "ASSETS: %s loaded, %dx%d atlas, %d sprites, %d glyphs in %.2f ms", path,
+			 archive->atlas.width, archive->atlas.height, archive->spriteCount, archive->font.glyphCount, archive->loadMs);
+	return archive->loaded;
+}
+
+static inline void UnloadAssetArchive(AssetArchive *archive) {
+	if (archive->atlas.id != 0) {
+		UnloadTexture(archive->atlas);
+	}
+	// The font shares the atlas texture, so it is not passed to UnloadFont()
+	MemFree(archive->font.recs);
+	MemFree(archive->font.glyphs);
+	MemFree(archive->sprites);
+	memset(archive, 0, sizeof(*archive));
+}
+
+// Returns the frame of a group to show at `time`, or NULL if the group is empty.
+static inline const AssetSprite *AssetGroupFrame(const AssetArchive *archive, AssetGroup group, double time, float fps) {
+	if (!archive->loaded || archive->groupFrames[group] == 0) {
+		return NULL;
+	}
+	int frame = (int)(time * fps) % archive->groupFrames[group];
+	return &archive->sprites[archive->groupStart[group] + frame];
+}
+
+#endif // ASSET_ARCHIVE_H
@@ -0,0 +1,255 @@
+// Offline packer that turns loose sprite images and a font into the archive
+// the game loads at startup (see asset_archive.h).
+//
+//   g++ -O2 -std=c++20 asset_packer.cpp -lraylib -o asset_packer
+//   asset_packer [-o assets.pak] [--font file.ttf] [--font-size 32] sprite.png ...
+//
+// A sprite's group comes from its file name prefix (player_, enemy_normal_,
+// enemy_elite_, enemy_boss_, fx_) and a trailing _<n> is its animation frame,
+// so enemy_elite_0.png .. enemy_elite_3.png become the elite's four frames.
+// Only raylib's CPU-side image and font loaders are used; no window is opened.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "raylib.h"
+#include "asset_archive.h"
+
+#define ATLAS_WIDTH 1024
+#define ATLAS_MAX_HEIGHT 8192
+#define ATLAS_PADDING 1
+#define FONT_GLYPH_COUNT 95		// printable ASCII, same set raylib loads by default
+#define FONT_DEFAULT_SIZE 32
+
+typedef struct {
+	Image image;		// RGBA8
+	bool isGlyph;
+	int index;			// into sprites[] or glyphs[]
+	int x;
+	int y;
+} PackItem;
+
+static const struct {
+	const char *prefix;
+	AssetGroup group;
+} groupPrefixes[] = {
+	{ "player_", ASSET_GROUP_PLAYER },
+	{ "enemy_normal_", ASSET_GROUP_ENEMY_NORMAL },
+	{ "enemy_elite_", ASSET_GROUP_ENEMY_ELITE },
+	{ "enemy_boss_", ASSET_GROUP_ENEMY_BOSS },
+	{ "fx_", ASSET_GROUP_EFFECT },
+};
+
+static void ClassifySprite(AssetSprite *sprite, const char *name) {
+	snprintf(sprite->name, ASSET_NAME_LENGTH, "%s", name);
+	sprite->group = ASSET_GROUP_MISC;
+	for (size_t i = 0; i < sizeof(groupPrefixes)/sizeof(groupPrefixes[0]); i++) {
+		if (strncmp(name, groupPrefixes[i].prefix, strlen(groupPrefixes[i].prefix)) == 0) {
+			sprite->group = groupPrefixes[i].group;
+			break;
+		}
+	}
+	
+	const char *suffix = strrchr(name, '_');
+	sprite->frame = 0;
+	if (suffix != NULL && isdigit((unsigned char)suffix[1])) {
+		sprite->frame = (int16_t)atoi(suffix + 1);
+	}
+}
+
+// Tallest first gives the simple shelf packer below a reasonably dense atlas.
+static int CompareItemHeight(const void *a, const void *b) {
+	return ((const PackItem *)b)->image.height - ((const PackItem *)a)->image.height;
+}
+
+static int CompareSprites(const void *a, const void *b) {
+	const AssetSprite *sa = (const AssetSprite *)a;
+	const AssetSprite *sb = (const AssetSprite *)b;
+	if (sa->group != sb->group) {
+		return sa->group - sb->group;
+	}
+	return sa->frame - sb->frame;
+}
+
+// Places items on horizontal shelves. Returns the used height, or -1 if an
+// item does not fit.
+static int PackShelves(PackItem *items, int count) {
+	qsort(items, count, sizeof(PackItem), CompareItemHeight);
+	
+	int x = 0;
+	int y = 0;
+	int shelfHeight = 0;
+	for (int i = 0; i < count; i++) {
+		int width = items[i].image.width + ATLAS_PADDING;
+		int height = items[i].image.height + ATLAS_PADDING;
+		if (width > ATLAS_WIDTH) {
+			return -1;
+		}
+		if (x + width > ATLAS_WIDTH) {
+			x = 0;
+			y += shelfHeight;
+			shelfHeight = 0;
+		}
+		items[i].x = x;
+		items[i].y = y;
+		x += width;
+		if (height > shelfHeight) {
+			shelfHeight = height;
+		}
+	}
+	return y + shelfHeight;
+}
+
+// Glyph bitmaps come back as 8-bit coverage; the atlas stores them as white
+// with coverage in alpha, the same way raylib builds its own font atlases.
+static Image GlyphToRGBA(Image glyph) {
+	Image image = GenImageColor((glyph.width > 0) ? glyph.width : 1, (glyph.height > 0) ? glyph.height : 1, BLANK);
+	const unsigned char *coverage = (const unsigned char *)glyph.data;
+	unsigned char *pixels = (unsigned char *)image.data;
+	for (int i = 0; i < glyph.width * glyph.height; i++) {
+		pixels[i*4 + 0] = 255;
+		pixels[i*4 + 1] = 255;
+		pixels[i*4 + 2] = 255;
+		pixels[i*4 + 3] = coverage[i];
+	}
+	return image;
+}
+
+static bool WriteArchive(const char *path, const AssetArchiveHeader *header, const AssetSprite *sprites,
+						 const AssetGlyph *glyphs, const Image *atlas) {
+	FILE *file = fopen(path, "wb");
+	if (!file) {
+		return false;
+	}
+	static const unsigned char zeros[ASSET_DATA_ALIGNMENT] = {0};
+	size_t tablesEnd = header->glyphOffset + header->glyphCount * sizeof(AssetGlyph);
+	
+	bool ok = fwrite(header, sizeof(*header), 1, file) == 1 &&
+			  fwrite(sprites, sizeof(AssetSprite), header->spriteCount, file) == header->spriteCount &&
+			  fwrite(glyphs, sizeof(AssetGlyph), header->glyphCount, file) == header->glyphCount &&
+			  fwrite(zeros, 1, header->pixelOffset - tablesEnd, file) == header->pixelOffset - tablesEnd &&
+			  fwrite(atlas->data, 1, header->pixelSize, file) == header->pixelSize;
+	return (fclose(file) == 0) && ok;
+}
+
+int main(int argc, char **argv) {
+	const char *outputPath = ASSET_ARCHIVE_FILE;
+	const char *fontPath = NULL;
+	int fontSize = FONT_DEFAULT_SIZE;
+	
+	PackItem *items = (PackItem *)calloc(argc + FONT_GLYPH_COUNT, sizeof(PackItem));
+	AssetSprite *sprites = (AssetSprite *)calloc(argc, sizeof(AssetSprite));
+	AssetGlyph *glyphs = (AssetGlyph *)calloc(FONT_GLYPH_COUNT, sizeof(AssetGlyph));
+	int itemCount = 0;
+	int spriteCount = 0;
+	int glyphCount = 0;
+	
+	SetTraceLogLevel(LOG_WARNING);
+	
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			outputPath = argv[++i];
+		} else if (strcmp(argv[i], "--font") == 0 && i + 1 < argc) {
+			fontPath = argv[++i];
+		} else if (strcmp(argv[i], "--font-size") == 0 && i + 1 < argc) {
+			fontSize = atoi(argv[++i]);
+		} else {
+			Image image = LoadImage(argv[i]);
+			if (image.data == NULL) {
+				fprintf(stderr, "cannot load %s\n", argv[i]);
+				return 1;
+			}
+			ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+			ClassifySprite(&sprites[spriteCount], GetFileNameWithoutExt(argv[i]));
+			items[itemCount++] = (PackItem){ image, false, spriteCount++, 0, 0 };
+		}
+	}
+	
+	if (fontPath != NULL) {
+		int dataSize = 0;
+		unsigned char *data = LoadFileData(fontPath, &dataSize);
+		GlyphInfo *fontGlyphs = (data != NULL) ? LoadFontData(data, dataSize, fontSize, NULL, FONT_GLYPH_COUNT, FONT_DEFAULT) : NULL;
+		if (fontGlyphs == NULL) {
+			fprintf(stderr, "cannot load font %s\n", fontPath);
+			return 1;
+		}
+		for (int i = 0; i < FONT_GLYPH_COUNT; i++) {
+			glyphs[glyphCount] = (AssetGlyph){
+				fontGlyphs[i].value, fontGlyphs[i].offsetX, fontGlyphs[i].offsetY, fontGlyphs[i].advanceX,
+				0.0f, 0.0f, (float)fontGlyphs[i].image.width, (float)fontGlyphs[i].image.height
+			};
+			items[itemCount++] = (PackItem){ GlyphToRGBA(fontGlyphs[i].image), true, glyphCount++, 0, 0 };
+		}
+		UnloadFontData(fontGlyphs, FONT_GLYPH_COUNT);
+		UnloadFileData(data);
+	}
+	
+	if (itemCount == 0) {
+		fprintf(stderr, "usage: %s [-o %s] [--font file.ttf] [--font-size %d] sprite.png ...\n",
+				argv[0], ASSET_ARCHIVE_FILE, FONT_DEFAULT_SIZE);
+		return 1;
+	}
+	
+	int usedHeight = PackShelves(items, itemCount);
+	int atlasHeight = 64;
+	while (atlasHeight < usedHeight) {
+		atlasHeight *= 2;
+	}
+	if (usedHeight < 0 || atlasHeight > ATLAS_MAX_HEIGHT) {
+		fprintf(stderr, "sprites do not fit in a %dx%d atlas\n", ATLAS_WIDTH, ATLAS_MAX_HEIGHT);
+		return 1;
+	}
+	
+	// Rows are copied rather than ImageDraw()n so alpha is stored as-is, not blended
+	Image atlas = GenImageColor(ATLAS_WIDTH, atlasHeight, BLANK);
+	for (int i = 0; i < itemCount; i++) {
+		const PackItem *item = &items[i];
+		for (int row = 0; row < item->image.height; row++) {
+			memcpy((unsigned char *)atlas.data + ((size_t)(item->y + row) * ATLAS_WIDTH + item->x) * 4,
+				   (const unsigned char *)item->image.data + (size_t)row * item->image.width * 4,
+				   (size_t)item->image.width * 4);
+		}
+		
+		if (item->isGlyph) {
+			glyphs[item->index].x = (float)item->x;
+			glyphs[item->index].y = (float)item->y;
+		} else {
+			sprites[item->index].x = (float)item->x;
+			sprites[item->index].y = (float)item->y;
+			sprites[item->index].width = (float)item->image.width;
+			sprites[item->index].height = (float)item->image.height;
+		}
+		UnloadImage(item->image);
+	}
+	qsort(sprites, spriteCount, sizeof(AssetSprite), CompareSprites);
+	
+	AssetArchiveHeader header = {0};
+	header.magic = ASSET_ARCHIVE_MAGIC;
+	header.version = ASSET_ARCHIVE_VERSION;
+	header.headerSize = sizeof(AssetArchiveHeader);
+	header.atlasWidth = ATLAS_WIDTH;
+	header.atlasHeight = atlasHeight;
+	header.pixelFormat = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+	header.spriteCount = spriteCount;
+	header.spriteOffset = sizeof(AssetArchiveHeader);
+	header.glyphCount = glyphCount;
+	header.glyphOffset = header.spriteOffset + spriteCount * sizeof(AssetSprite);
+	header.fontBaseSize = (glyphCount > 0) ? fontSize : 0;
+	header.pixelOffset = (header.glyphOffset + glyphCount * sizeof(AssetGlyph) + ASSET_DATA_ALIGNMENT - 1) & ~(ASSET_DATA_ALIGNMENT - 1);
+	header.pixelSize = ATLAS_WIDTH * atlasHeight * 4;
+	
+	if (!WriteArchive(outputPath, &header, sprites, glyphs, &atlas)) {
+		fprintf(stderr, "cannot write %s\n", outputPath);
+		return 1;
+	}
+	printf("%s: %dx%d atlas (%d%% used), %d sprites, %d glyphs, %u bytes\n", outputPath, ATLAS_WIDTH, atlasHeight,
+		   usedHeight * 100 / atlasHeight, spriteCount, glyphCount, header.pixelOffset + header.pixelSize);
+	
+	UnloadImage(atlas);
+	free(items);
+	free(sprites);
+	free(glyphs);
+	return 0;
+}
@@ -0,0 +1,531 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+// Sound effect mixer.
+//
+// Every effect is decoded once at startup into a cache of mono float PCM at
+// the output rate: from assets/sfx/<name>.wav when present, otherwise
+// synthesized, so the game always has sound. Gameplay calls PlaySfx(), which
+// only queues a small command. A mixer thread drains the queue, assigns
+// voices from a fixed pool and mixes the active voices into stereo blocks
+// with SSE.
+//
+// Two limits keep a bullet storm cheap:
+//  - Per tick, each effect may start at most `perTickLimit` times. Further
+//    requests in the same tick are dropped on the game thread.
+//  - When the pool is full, the new sound steals the lowest priority voice
+//    (the oldest among equals), or is dropped if everything playing is more
+//    important.
+//
+// Backends: the raylib audio device, a null sink, or a 16-bit WAV file. The
+// null and file sinks are paced by the wall clock, so they behave like a
+// device on machines without one.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "raylib.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <xmmintrin.h>
+	#define AUDIO_SIMD 1
+#else
+	#define AUDIO_SIMD 0
+#endif
+
+#define AUDIO_SAMPLE_RATE 48000
+#define AUDIO_BLOCK_FRAMES 256			// ~5.3 ms per mix
+#define AUDIO_RING_FRAMES (AUDIO_BLOCK_FRAMES*4)
+#define AUDIO_VOICES 32
+#define AUDIO_COMMAND_QUEUE 64
+#define AUDIO_SFX_DIRECTORY "assets/sfx"
+
+typedef enum {
+	AUDIO_BACKEND_DEVICE,
+	AUDIO_BACKEND_NULL,
+	AUDIO_BACKEND_FILE
+} AudioBackend;
+
+typedef enum {
+	SFX_SHOT,
+	SFX_HIT,
+	SFX_EXPLOSION,
+	SFX_BOMB,
+	SFX_BOSS_SPAWN,
+	SFX_PICKUP,
+	SFX_PLAYER_HIT,
+	SFX_COUNT
+} SoundEffect;
+
+typedef struct {
+	const char *name;		// assets/sfx/<name>.wav
+	int priority;			// higher steals lower
+	float gain;
+	int perTickLimit;
+	// Fallback synthesis: a swept square wave blended with noise, decaying out
+	float duration;
+	float startHz;
+	float endHz;
+	float noise;
+} SfxConfig;
+
+static const SfxConfig sfxConfigs[SFX_COUNT] = {
+	{ "shot", 1, 0.20f, 2, 0.08f, 1400.0f, 600.0f, 0.1f },
+	{ "hit", 2, 0.30f, 3, 0.06f, 400.0f, 200.0f, 0.6f },
+	{ "explosion", 3, 0.45f, 2, 0.35f, 150.0f, 40.0f, 0.8f },
+	{ "bomb", 5, 0.80f, 1, 0.90f, 80.0f, 30.0f, 0.7f },
+	{ "boss_spawn", 6, 0.60f, 1, 1.20f, 220.0f, 110.0f, 0.1f },
+	{ "pickup", 4, 0.40f, 1, 0.25f, 600.0f, 1200.0f, 0.0f },
+	{ "player_hit", 5, 0.60f, 1, 0.30f, 300.0f, 80.0f, 0.4f },
+};
+
+typedef struct {
+	float *samples;			// mono, AUDIO_SAMPLE_RATE
+	int frameCount;
+	bool fromFile;
+} PcmClip;
+
+typedef struct {
+	bool active;
+	SoundEffect sfx;
+	int position;			// frames already played
+	float gainLeft;
+	float gainRight;
+	int priority;
+	uint64_t started;		// mixer block the voice started on, for oldest-first stealing
+} Voice;
+
+typedef struct {
+	SoundEffect sfx;
+	float pan;				// 0 = left, 1 = right
+} AudioCommand;
+
+typedef struct {
+	int requested;
+	int rateLimited;		// dropped by the per-tick limit
+	int stolen;
+	int dropped;			// no voice free and nothing cheaper to steal
+	int activeVoices;
+	int peakVoices;
+	int underruns;			// device asked for more than the mixer had ready
+	uint64_t blocks;
+	float mixUs;			// smoothed cost of one block
+} AudioStats;
+
+typedef struct {
+	AudioBackend backend;
+	PcmClip clips[SFX_COUNT];
+	
+	// Game thread only
+	int tickCounts[SFX_COUNT];
+	int requested;
+	int rateLimited;
+	
+	// Shared, under lock
+	std::mutex lock;
+	AudioCommand commands[AUDIO_COMMAND_QUEUE];
+	int commandCount;
+	AudioStats stats;
+	
+	// Mixer thread only
+	Voice voices[AUDIO_VOICES];
+	alignas(16) float block[AUDIO_BLOCK_FRAMES*2];
+	std::thread mixer;
+	std::atomic<bool> quit;
+	FILE *file;
+	uint32_t fileFrames;
+	
+	// Device backend: mixer thread produces, audio device thread consumes
+	AudioStream stream;
+	alignas(16) float ring[AUDIO_RING_FRAMES*2];
+	std::atomic<uint32_t> ringRead;
+	std::atomic<uint32_t> underruns;	// counted on the device thread, which must never block
+	std::atomic<uint32_t> ringWrite;
+} AudioMixer;
+
+static void SynthesizeClip(PcmClip *clip, const SfxConfig *config) {
+	clip->frameCount = (int)(config->duration * AUDIO_SAMPLE_RATE);
+	clip->samples = (float *)MemAlloc(clip->frameCount * sizeof(float));
+	clip->fromFile = false;
+	
+	uint32_t noiseState = 0x9E3779B9u;
+	float phase = 0.0f;
+	for (int i = 0; i < clip->frameCount; i++) {
+		float t = (float)i / clip->frameCount;
+		float hz = config->startHz + (config->endHz - config->startHz) * t;
+		phase += hz / AUDIO_SAMPLE_RATE;
+		phase -= floorf(phase);
+		
+		noiseState ^= noiseState << 13;
+		noiseState ^= noiseState >> 17;
+		noiseState ^= noiseState << 5;
+		float noise = (noiseState / 4294967295.0f) * 2.0f - 1.0f;
+		float square = (phase < 0.5f) ? 1.0f : -1.0f;
+		float envelope = (1.0f - t) * (1.0f - t);
+		clip->samples[i] = (square * (1.0f - config->noise) + noise * config->noise) * envelope;
+	}
+}
+
+// Decodes one effect to mono float at the output rate.
+static void LoadClip(PcmClip *clip, const SfxConfig *config) {
+	const char *path = TextFormat("%s/%s.wav", AUDIO_SFX_DIRECTORY, config->name);
+	if (FileExists(path)) {
+		Wave wave = LoadWave(path);
+		if (wave.frameCount > 0) {
+			WaveFormat(&wave, AUDIO_SAMPLE_RATE, 32, 1);
+			float *samples = LoadWaveSamples(wave);
+			clip->frameCount = (int)wave.frameCount;
+			clip->samples = (float *)MemAlloc(clip->frameCount * sizeof(float));
+			memcpy(clip->samples, samples, clip->frameCount * sizeof(float));
+			clip->fromFile = true;
+			UnloadWaveSamples(samples);
+			UnloadWave(wave);
+			return;
+		}
+		UnloadWave(wave);
+	}
+	SynthesizeClip(clip, config);
+}
+
+// Adds `frames` mono samples into an interleaved stereo buffer.
+static void MixVoice(float *out, const float *samples, int frames, float gainLeft, float gainRight) {
+	int i = 0;
+#if AUDIO_SIMD
+	__m128 gains = _mm_setr_ps(gainLeft, gainRight, gainLeft, gainRight);
+	for (; i + 4 <= frames; i += 4) {
+		__m128 mono = _mm_loadu_ps(samples + i);
+		__m128 low = _mm_unpacklo_ps(mono, mono);		// s0 s0 s1 s1
+		__m128 high = _mm_unpackhi_ps(mono, mono);		// s2 s2 s3 s3
+		_mm_store_ps(out + i*2, _mm_add_ps(_mm_load_ps(out + i*2), _mm_mul_ps(low, gains)));
+		_mm_store_ps(out + i*2 + 4, _mm_add_ps(_mm_load_ps(out + i*2 + 4), _mm_mul_ps(high, gains)));
+	}
+#endif
+	for (; i < frames; i++) {
+		out[i*2] += samples[i] * gainLeft;
+		out[i*2 + 1] += samples[i] * gainRight;
+	}
+}
+
+static void ClampBlock(float *out, int count) {
+	int i = 0;
+#if AUDIO_SIMD
+	__m128 low = _mm_set1_ps(-1.0f);
+	__m128 high = _mm_set1_ps(1.0f);
+	for (; i + 4 <= count; i += 4) {
+		_mm_store_ps(out + i, _mm_min_ps(_mm_max_ps(_mm_load_ps(out + i), low), high));
+	}
+#endif
+	for (; i < count; i++) {
+		out[i] = fminf(fmaxf(out[i], -1.0f), 1.0f);
+	}
+}
+
+static void StartVoice(AudioMixer *audio, const AudioCommand *command, AudioStats *stats) {
+	const SfxConfig *config = &sfxConfigs[command->sfx];
+	Voice *voice = NULL;
+	for (int i = 0; i < AUDIO_VOICES && voice == NULL; i++) {
+		if (!audio->voices[i].active) {
+			voice = &audio->voices[i];
+		}
+	}
+	
+	if (voice == NULL) {
+		Voice *victim = NULL;
+		for (int i = 0; i < AUDIO_VOICES; i++) {
+			Voice *candidate = &audio->voices[i];
+			if (candidate->priority > config->priority) {
+				continue;
+			}
+			if (victim == NULL || candidate->priority < victim->priority ||
+				(candidate->priority == victim->priority && candidate->started < victim->started)) {
+				victim = candidate;
+			}
+		}
+		if (victim == NULL) {
+			stats->dropped++;
+			return;
+		}
+		stats->stolen++;
+		voice = victim;
+	}
+	
+	// Constant-power pan
+	float angle = command->pan * (PI/2);
+	*voice = (Voice){
+		.active = true,
+		.sfx = command->sfx,
+		.position = 0,
+		.gainLeft = cosf(angle) * config->gain,
+		.gainRight = sinf(angle) * config->gain,
+		.priority = config->priority,
+		.started = stats->blocks
+	};
+}
+
+// Mixes one block into audio->block. Mixer thread (or the caller when driven
+// by hand, as the benchmark does).
+static void MixAudioBlock(AudioMixer *audio) {
+	auto start = std::chrono::steady_clock::now();
+	
+	AudioCommand commands[AUDIO_COMMAND_QUEUE];
+	int commandCount;
+	AudioStats stats;
+	{
+		std::lock_guard<std::mutex> guard(audio->lock);
+		commandCount = audio->commandCount;
+		memcpy(commands, audio->commands, commandCount * sizeof(AudioCommand));
+		audio->commandCount = 0;
+		stats = audio->stats;
+	}
+	
+	for (int i = 0; i < commandCount; i++) {
+		StartVoice(audio, &commands[i], &stats);
+	}
+	
+	memset(audio->block, 0, sizeof(audio->block));
+	int active = 0;
+	for (int i = 0; i < AUDIO_VOICES; i++) {
+		Voice *voice = &audio->voices[i];
+		if (!voice->active) {
+			continue;
+		}
+		const PcmClip *clip = &audio->clips[voice->sfx];
+		int frames = clip->frameCount - voice->position;
+		if (frames > AUDIO_BLOCK_FRAMES) {
+			frames = AUDIO_BLOCK_FRAMES;
+		}
+		MixVoice(audio->block, clip->samples + voice->position, frames, voice->gainLeft, voice->gainRight);
+		voice->position += frames;
+		if (voice->position >= clip->frameCount) {
+			voice->active = false;
+		}
+		active++;
+	}
+	ClampBlock(audio->block, AUDIO_BLOCK_FRAMES*2);
+	
+	float mixUs = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+	std::lock_guard<std::mutex> guard(audio->lock);
+	audio->stats.stolen = stats.stolen;
+	audio->stats.dropped = stats.dropped;
+	audio->stats.activeVoices = active;
+	if (active > audio->stats.peakVoices) {
+		audio->stats.peakVoices = active;
+	}
+	audio->stats.blocks++;
+	audio->stats.mixUs += (mixUs - audio->stats.mixUs) * 0.05f;
+}
+
+static void WriteWavHeader(FILE *file, uint32_t frames) {
+	uint32_t dataSize = frames * 2 * sizeof(int16_t);
+	uint32_t riffSize = 36 + dataSize;
+	uint32_t fmtSize = 16;
+	uint16_t pcm = 1;
+	uint16_t channels = 2;
+	uint32_t rate = AUDIO_SAMPLE_RATE;
+	uint32_t byteRate = AUDIO_SAMPLE_RATE * 2 * sizeof(int16_t);
+	uint16_t blockAlign = 2 * sizeof(int16_t);
+	uint16_t bits = 16;
+	
+	fseek(file, 0, SEEK_SET);
+	fwrite("RIFF", 1, 4, file);
+	fwrite(&riffSize, 4, 1, file);
+	fwrite("WAVEfmt ", 1, 8, file);
+	fwrite(&fmtSize, 4, 1, file);
+	fwrite(&pcm, 2, 1, file);
+	fwrite(&channels, 2, 1, file);
+	fwrite(&rate, 4, 1, file);
+	fwrite(&byteRate, 4, 1, file);
+	fwrite(&blockAlign, 2, 1, file);
+	fwrite(&bits, 2, 1, file);
+	fwrite("data", 1, 4, file);
+	fwrite(&dataSize, 4, 1, file);
+	fseek(file, 0, SEEK_END);
+}
+
+// Hands the finished block to the backend.
+static void DeliverAudioBlock(AudioMixer *audio) {
+	if (audio->backend == AUDIO_BACKEND_FILE) {
+		int16_t pcm[AUDIO_BLOCK_FRAMES*2];
+		for (int i = 0; i < AUDIO_BLOCK_FRAMES*2; i++) {
+			pcm[i] = (int16_t)(audio->block[i] * 32767.0f);
+		}
+		fwrite(pcm, sizeof(pcm), 1, audio->file);
+		audio->fileFrames += AUDIO_BLOCK_FRAMES;
+	} else if (audio->backend == AUDIO_BACKEND_DEVICE) {
+		uint32_t write = audio->ringWrite.load(std::memory_order_relaxed);
+		for (int i = 0; i < AUDIO_BLOCK_FRAMES; i++) {
+			uint32_t slot = (write + i) % AUDIO_RING_FRAMES;
+			audio->ring[slot*2] = audio->block[i*2];
+			audio->ring[slot*2 + 1] = audio->block[i*2 + 1];
+		}
+		audio->ringWrite.store(write + AUDIO_BLOCK_FRAMES, std::memory_order_release);
+	}
+}
+
+static AudioMixer *deviceMixer = NULL;
+
+// Runs on raylib's audio thread.
+static void AudioDeviceCallback(void *buffer, unsigned int frames) {
+	AudioMixer *audio = deviceMixer;
+	float *out = (float *)buffer;
+	uint32_t read = audio->ringRead.load(std::memory_order_relaxed);
+	uint32_t available = audio->ringWrite.load(std::memory_order_acquire) - read;
+	uint32_t count = (frames < available) ? frames : available;
+	
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t slot = (read + i) % AUDIO_RING_FRAMES;
+		out[i*2] = audio->ring[slot*2];
+		out[i*2 + 1] = audio->ring[slot*2 + 1];
+	}
+	if (count < frames) {
+		memset(out + count*2, 0, (frames - count) * 2 * sizeof(float));
+		audio->underruns.fetch_add(1, std::memory_order_relaxed);
+	}
+	audio->ringRead.store(read + count, std::memory_order_release);
+}
+
+static void AudioMixerRun(AudioMixer *audio) {
+	const auto blockPeriod = std::chrono::microseconds(1000000LL * AUDIO_BLOCK_FRAMES / AUDIO_SAMPLE_RATE);
+	auto nextBlock = std::chrono::steady_clock::now();
+	
+	while (!audio->quit.load()) {
+		if (audio->backend == AUDIO_BACKEND_DEVICE) {
+			// Stay one ring ahead of the device
+			uint32_t queued = audio->ringWrite.load(std::memory_order_relaxed) - audio->ringRead.load(std::memory_order_acquire);
+			if (queued + AUDIO_BLOCK_FRAMES > AUDIO_RING_FRAMES) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				continue;
+			}
+		} else {
+			std::this_thread::sleep_until(nextBlock);
+			nextBlock += blockPeriod;
+		}
+		MixAudioBlock(audio);
+		DeliverAudioBlock(audio);
+	}
+}
+
+// Falls back to the null backend when the device or the file cannot be opened.
+static void InitAudioMixer(AudioMixer *audio, AudioBackend backend, const char *filePath) {
+	for (int i = 0; i < SFX_COUNT; i++) {
+		LoadClip(&audio->clips[i], &sfxConfigs[i]);
+	}
+	memset(audio->voices, 0, sizeof(audio->voices));
+	memset(audio->tickCounts, 0, sizeof(audio->tickCounts));
+	audio->requested = 0;
+	audio->rateLimited = 0;
+	audio->underruns = 0;
+	audio->commandCount = 0;
+	audio->stats = (AudioStats){0};
+	audio->quit = false;
+	audio->file = NULL;
+	audio->fileFrames = 0;
+	audio->ringRead = 0;
+	audio->ringWrite = 0;
+	audio->backend = backend;
+	
+	if (backend == AUDIO_BACKEND_DEVICE) {
+		InitAudioDevice();
+		if (IsAudioDeviceReady()) {
+			deviceMixer = audio;
+			SetAudioStreamBufferSizeDefault(AUDIO_BLOCK_FRAMES);
+			audio->stream = LoadAudioStream(AUDIO_SAMPLE_RATE, 32, 2);
+			SetAudioStreamCallback(audio->stream, AudioDeviceCallback);
+		} else {
+			TraceLog(LOG_WARNING, "AUDIO: no audio device, using the null backend");
+			audio->backend = AUDIO_BACKEND_NULL;
+		}
+	} else if (backend == AUDIO_BACKEND_FILE) {
+		audio->file = fopen(filePath, "wb");
+		if (audio->file) {
+			WriteWavHeader(audio->file, 0);
+		} else {
+			TraceLog(LOG_WARNING, "AUDIO: cannot create %s, using the null backend", filePath);
+			audio->backend = AUDIO_BACKEND_NULL;
+		}
+	}
+}
+
+static void StartAudioMixer(AudioMixer *audio) {
+	if (audio->backend == AUDIO_BACKEND_DEVICE) {
+		// Prime the ring so the device does not start on an underrun
+		while (audio->ringWrite.load() + AUDIO_BLOCK_FRAMES <= AUDIO_RING_FRAMES) {
+			MixAudioBlock(audio);
+			DeliverAudioBlock(audio);
+		}
+		PlayAudioStream(audio->stream);
+	}
+	audio->mixer = std::thread(AudioMixerRun, audio);
+}
+
+static void CloseAudioMixer(AudioMixer *audio) {
+	audio->quit = true;
+	if (audio->mixer.joinable()) {
+		audio->mixer.join();
+	}
+	
+	if (audio->backend == AUDIO_BACKEND_DEVICE) {
+		StopAudioStream(audio->stream);
+		UnloadAudioStream(audio->stream);
+		CloseAudioDevice();
+		deviceMixer = NULL;
+	} else if (audio->backend == AUDIO_BACKEND_FILE) {
+		WriteWavHeader(audio->file, audio->fileFrames);
+		fclose(audio->file);
+	}
+	
+	for (int i = 0; i < SFX_COUNT; i++) {
+		MemFree(audio->clips[i].samples);
+		audio->clips[i].samples = NULL;
+	}
+}
+
+// Call at the start of every game tick.
+static void BeginAudioTick(AudioMixer *audio) {
+	memset(audio->tickCounts, 0, sizeof(audio->tickCounts));
+}
+
+// Queues an effect. `pan` is 0 (left) to 1 (right). Safe to call hundreds of
+// times a tick: past the per-tick limit it only bumps a counter, and only the
+// calls that queue a command take the mixer's lock.
+static void PlaySfx(AudioMixer *audio, SoundEffect sfx, float pan) {
+	audio->requested++;
+	if (audio->tickCounts[sfx] >= sfxConfigs[sfx].perTickLimit) {
+		audio->rateLimited++;
+		return;
+	}
+	audio->tickCounts[sfx]++;
+	
+	bool queued = false;
+	{
+		std::lock_guard<std::mutex> guard(audio->lock);
+		if (audio->commandCount < AUDIO_COMMAND_QUEUE) {
+			audio->commands[audio->commandCount++] = (AudioCommand){ sfx, fminf(fmaxf(pan, 0.0f), 1.0f) };
+			queued = true;
+		}
+	}
+	if (!queued) {
+		audio->rateLimited++;
+	}
+}
+
+// Game thread.
+static AudioStats GetAudioStats(AudioMixer *audio) {
+	AudioStats stats;
+	{
+		std::lock_guard<std::mutex> guard(audio->lock);
+		stats = audio->stats;
+	}
+	stats.requested = audio->requested;
+	stats.rateLimited = audio->rateLimited;
+	stats.underruns = (int)audio->underruns.load(std::memory_order_relaxed);
+	return stats;
+}
+
+#endif // AUDIO_H
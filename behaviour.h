@@ -0,0 +1,171 @@
+#ifndef BEHAVIOUR_H
+#define BEHAVIOUR_H
+
+// Coroutine-scripted enemy behaviours (C++20).
+//
+// A behaviour is a coroutine returning BehaviourTask. It suspends on the
+// awaitables below and StepBehaviour() resumes it at most once per tick, when
+// whatever it is waiting on has finished. Movement requested by a script is
+// carried out by StepBehaviour itself, so scripts only describe sequencing.
+//
+// Coroutine frames live for as long as the enemy, so they are carved from a
+// fixed pool of blocks instead of the heap. If the pool is exhausted the
+// enemy simply spawns without a script.
+
+#include <coroutine>
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include "raylib.h"
+
+#define BEHAVIOUR_ARENA_BLOCKS 32
+#define BEHAVIOUR_BLOCK_SIZE 256
+
+typedef struct {
+	alignas(max_align_t) unsigned char blocks[BEHAVIOUR_ARENA_BLOCKS][BEHAVIOUR_BLOCK_SIZE];
+	int freeList[BEHAVIOUR_ARENA_BLOCKS];
+	int freeCount;
+	int peakInUse;
+	int failedAllocs;
+	size_t largestFrame;
+	uint64_t resumes;
+} BehaviourArena;
+
+static BehaviourArena behaviourArena;
+
+static void InitBehaviourArena(void) {
+	for (int i = 0; i < BEHAVIOUR_ARENA_BLOCKS; i++) {
+		behaviourArena.freeList[i] = BEHAVIOUR_ARENA_BLOCKS - 1 - i;
+	}
+	behaviourArena.freeCount = BEHAVIOUR_ARENA_BLOCKS;
+	behaviourArena.peakInUse = 0;
+	behaviourArena.failedAllocs = 0;
+	behaviourArena.largestFrame = 0;
+	behaviourArena.resumes = 0;
+}
+
+static inline int BehaviourBlocksInUse(void) {
+	return BEHAVIOUR_ARENA_BLOCKS - behaviourArena.freeCount;
+}
+
+static void *BehaviourArenaAlloc(size_t size) {
+	if (size > behaviourArena.largestFrame) {
+		behaviourArena.largestFrame = size;
+	}
+	if (size > BEHAVIOUR_BLOCK_SIZE || behaviourArena.freeCount == 0) {
+		behaviourArena.failedAllocs++;
+		return NULL;
+	}
+	int block = behaviourArena.freeList[--behaviourArena.freeCount];
+	if (BehaviourBlocksInUse() > behaviourArena.peakInUse) {
+		behaviourArena.peakInUse = BehaviourBlocksInUse();
+	}
+	return behaviourArena.blocks[block];
+}
+
+static void BehaviourArenaFree(void *frame) {
+	int block = (int)(((unsigned char *)frame - behaviourArena.blocks[0]) / BEHAVIOUR_BLOCK_SIZE);
+	behaviourArena.freeList[behaviourArena.freeCount++] = block;
+}
+
+struct BehaviourTask {
+	struct promise_type {
+		BehaviourTask get_return_object() { return { std::coroutine_handle<promise_type>::from_promise(*this) }; }
+		static BehaviourTask get_return_object_on_allocation_failure() { return {}; }
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() {}
+		static void *operator new(size_t size) noexcept { return BehaviourArenaAlloc(size); }
+		static void operator delete(void *frame) noexcept { BehaviourArenaFree(frame); }
+	};
+	std::coroutine_handle<promise_type> handle;
+};
+
+typedef struct {
+	std::coroutine_handle<BehaviourTask::promise_type> handle;
+	float wait;				// seconds left before the script runs again
+	Vector2 target;			// where StepBehaviour is steering to
+	float moveSpeed;		// pixels per tick, 0 when not moving
+	bool waitForArrival;
+} BehaviourState;
+
+// Suspends the script for a number of seconds.
+struct WaitSeconds {
+	BehaviourState *state;
+	float seconds;
+	bool await_ready() const noexcept { return seconds <= 0.0f; }
+	void await_suspend(std::coroutine_handle<>) noexcept { state->wait = seconds; }
+	void await_resume() noexcept {}
+};
+
+// Starts moving towards a point without blocking the script.
+static void SetCourse(BehaviourState *state, Vector2 target, float speed) {
+	state->target = target;
+	state->moveSpeed = speed;
+}
+
+// Moves to a point and suspends the script until it gets there.
+struct MoveTo {
+	BehaviourState *state;
+	Vector2 target;
+	float speed;
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(std::coroutine_handle<>) noexcept {
+		SetCourse(state, target, speed);
+		state->waitForArrival = true;
+	}
+	void await_resume() noexcept {}
+};
+
+static void ReleaseBehaviour(BehaviourState *state) {
+	if (state->handle) {
+		state->handle.destroy();
+	}
+	*state = BehaviourState{};
+}
+
+static void StartBehaviour(BehaviourState *state, BehaviourTask task) {
+	ReleaseBehaviour(state);
+	state->handle = task.handle;
+}
+
+// Advances movement and resumes the script if nothing is holding it back.
+static void StepBehaviour(BehaviourState *state, Vector2 *position, float dt) {
+	if (!state->handle) {
+		return;
+	}
+	
+	if (state->moveSpeed > 0.0f) {
+		float dx = state->target.x - position->x;
+		float dy = state->target.y - position->y;
+		float distance = sqrtf(dx*dx + dy*dy);
+		if (distance <= state->moveSpeed) {
+			*position = state->target;
+			state->moveSpeed = 0.0f;
+		} else {
+			position->x += dx / distance * state->moveSpeed;
+			position->y += dy / distance * state->moveSpeed;
+		}
+	}
+	
+	if (state->wait > 0.0f) {
+		state->wait -= dt;
+		if (state->wait > 0.0f) {
+			return;
+		}
+	}
+	if (state->waitForArrival) {
+		if (state->moveSpeed > 0.0f) {
+			return;
+		}
+		state->waitForArrival = false;
+	}
+	
+	if (!state->handle.done()) {
+		state->handle.resume();
+		behaviourArena.resumes++;
+	}
+}
+
+#endif // BEHAVIOUR_H
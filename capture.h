@@ -0,0 +1,369 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+// Gameplay video capture to a raw Y4M file.
+//
+// Frames are read back through a ring of pixel pack buffers (PBOs). A capture
+// tick queues an asynchronous glReadPixels into a free buffer and returns at
+// once. A couple of frames later, when the GPU is long done with it, the
+// buffer is mapped and the encoder thread converts straight from the mapped
+// memory to YUV 4:2:0, so the pixels are never copied on the game thread.
+// When the encoder falls behind and no buffer is free, the frame is dropped
+// instead of stalling. The encoder repeats the previous frame for each
+// dropped one, so the video keeps real-time length.
+//
+// The PBO entry points are fetched through GLFW's loader (part of the raylib
+// desktop build), which is only referenced weakly. Builds without GLFW still
+// link, and capture reports itself unavailable when F9 is pressed.
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#define CAPTURE_RING_SIZE 4
+#define CAPTURE_READBACK_DELAY 2		// frames between queuing a readback and mapping it
+#define CAPTURE_FPS 30
+
+#if defined(_WIN32)
+	#define CAPTURE_GLAPI __stdcall
+#else
+	#define CAPTURE_GLAPI
+#endif
+
+#define CAPTURE_GL_RGBA 0x1908
+#define CAPTURE_GL_UNSIGNED_BYTE 0x1401
+#define CAPTURE_GL_PIXEL_PACK_BUFFER 0x88EB
+#define CAPTURE_GL_STREAM_READ 0x88E1
+#define CAPTURE_GL_READ_ONLY 0x88B8
+
+typedef void (*CaptureGLProc)(void);
+#if defined(_MSC_VER)
+	// MSVC has no weak symbols; the linker falls back to the stub if GLFW is absent
+	extern "C" CaptureGLProc glfwGetProcAddress(const char *name);
+	extern "C" CaptureGLProc CaptureMissingProcAddress(const char *name) { return NULL; }
+	#pragma comment(linker, "/alternatename:glfwGetProcAddress=CaptureMissingProcAddress")
+#else
+	extern "C" CaptureGLProc glfwGetProcAddress(const char *name) __attribute__((weak));
+#endif
+
+typedef struct {
+	void (CAPTURE_GLAPI *ReadPixels)(int x, int y, int width, int height, unsigned int format, unsigned int type, void *pixels);
+	void (CAPTURE_GLAPI *GenBuffers)(int count, unsigned int *buffers);
+	void (CAPTURE_GLAPI *DeleteBuffers)(int count, const unsigned int *buffers);
+	void (CAPTURE_GLAPI *BindBuffer)(unsigned int target, unsigned int buffer);
+	void (CAPTURE_GLAPI *BufferData)(unsigned int target, ptrdiff_t size, const void *data, unsigned int usage);
+	void *(CAPTURE_GLAPI *MapBuffer)(unsigned int target, unsigned int access);
+	unsigned char (CAPTURE_GLAPI *UnmapBuffer)(unsigned int target);
+} CaptureGL;
+
+typedef enum {
+	CAPTURE_SLOT_FREE,
+	CAPTURE_SLOT_READING,		// readback queued on the GPU
+	CAPTURE_SLOT_ENCODING,		// mapped, owned by the encoder thread
+	CAPTURE_SLOT_DONE			// encoder finished, waiting to be unmapped
+} CaptureSlotState;
+
+typedef struct {
+	unsigned int buffer;
+	CaptureSlotState state;
+	const unsigned char *pixels;	// mapped RGBA, bottom row first
+	int frame;						// video frame number
+	uint64_t readTick;				// tick the readback was queued on
+} CaptureSlot;
+
+typedef struct {
+	int captured;
+	int dropped;
+	int written;
+	float overheadMs;				// smoothed game-thread cost per frame
+	float encodeMs;					// smoothed encoder cost per frame
+} CaptureStats;
+
+typedef struct {
+	bool active;
+	CaptureGL gl;
+	int width;
+	int height;
+	FILE *file;
+	char path[64];
+	
+	CaptureSlot slots[CAPTURE_RING_SIZE];
+	int queue[CAPTURE_RING_SIZE];	// slots handed to the encoder, oldest first
+	int queueCount;
+	uint64_t tick;
+	double startTime;
+	int nextFrame;
+	
+	std::thread encoder;
+	std::mutex lock;
+	std::condition_variable wake;
+	bool quit;
+	unsigned char *yuv;				// encoder-owned, also the repeat source for drops
+	int lastWritten;
+	
+	CaptureStats stats;				// under the lock; read with GetCaptureStats()
+} CaptureState;
+
+static bool LoadCaptureGL(CaptureGL *gl) {
+#if !defined(_MSC_VER)
+	if (glfwGetProcAddress == NULL) {
+		return false;
+	}
+#endif
+	gl->ReadPixels = (decltype(gl->ReadPixels))glfwGetProcAddress("glReadPixels");
+	gl->GenBuffers = (decltype(gl->GenBuffers))glfwGetProcAddress("glGenBuffers");
+	gl->DeleteBuffers = (decltype(gl->DeleteBuffers))glfwGetProcAddress("glDeleteBuffers");
+	gl->BindBuffer = (decltype(gl->BindBuffer))glfwGetProcAddress("glBindBuffer");
+	gl->BufferData = (decltype(gl->BufferData))glfwGetProcAddress("glBufferData");
+	gl->MapBuffer = (decltype(gl->MapBuffer))glfwGetProcAddress("glMapBuffer");
+	gl->UnmapBuffer = (decltype(gl->UnmapBuffer))glfwGetProcAddress("glUnmapBuffer");
+	return gl->ReadPixels && gl->GenBuffers && gl->DeleteBuffers && gl->BindBuffer &&
+		   gl->BufferData && gl->MapBuffer && gl->UnmapBuffer;
+}
+
+// Full-range BT.601, flipping the bottom-up GL rows on the way.
+static void ConvertFrameToYUV420(const unsigned char *rgba, int width, int height, unsigned char *yuv) {
+	unsigned char *planeY = yuv;
+	unsigned char *planeU = yuv + width*height;
+	unsigned char *planeV = planeU + (width/2)*(height/2);
+	
+	for (int y = 0; y < height; y += 2) {
+		const unsigned char *row0 = rgba + (size_t)(height - 1 - y) * width * 4;
+		const unsigned char *row1 = row0 - (size_t)width * 4;
+		for (int x = 0; x < width; x += 2) {
+			int sumR = 0;
+			int sumG = 0;
+			int sumB = 0;
+			for (int i = 0; i < 4; i++) {
+				const unsigned char *p = ((i < 2) ? row0 : row1) + (x + (i & 1)) * 4;
+				planeY[(y + (i >> 1)) * width + x + (i & 1)] = (unsigned char)((77*p[0] + 150*p[1] + 29*p[2]) >> 8);
+				sumR += p[0];
+				sumG += p[1];
+				sumB += p[2];
+			}
+			int chroma = (y/2) * (width/2) + x/2;
+			planeU[chroma] = (unsigned char)(((-43*sumR - 85*sumG + 128*sumB) >> 10) + 128);
+			planeV[chroma] = (unsigned char)(((128*sumR - 107*sumG - 21*sumB) >> 10) + 128);
+		}
+	}
+}
+
+static void WriteCaptureFrame(CaptureState *capture) {
+	size_t size = (size_t)capture->width * capture->height * 3/2;
+	fputs("FRAME\n", capture->file);
+	fwrite(capture->yuv, 1, size, capture->file);
+	capture->lastWritten++;
+}
+
+static void CaptureEncoderRun(CaptureState *capture) {
+	std::unique_lock<std::mutex> guard(capture->lock);
+	for (;;) {
+		capture->wake.wait(guard, [capture] { return capture->queueCount > 0 || capture->quit; });
+		if (capture->queueCount == 0) {
+			break;
+		}
+		
+		CaptureSlot *slot = &capture->slots[capture->queue[0]];
+		guard.unlock();
+		
+		double start = GetTime();
+		// Fill the gap left by dropped frames with the last one we have
+		while (capture->lastWritten >= 0 && capture->lastWritten + 1 < slot->frame) {
+			WriteCaptureFrame(capture);
+		}
+		ConvertFrameToYUV420(slot->pixels, capture->width, capture->height, capture->yuv);
+		capture->lastWritten = slot->frame - 1;
+		WriteCaptureFrame(capture);
+		float encodeMs = (float)((GetTime() - start) * 1000.0);
+		
+		guard.lock();
+		slot->state = CAPTURE_SLOT_DONE;
+		capture->queueCount--;
+		memmove(capture->queue, capture->queue + 1, capture->queueCount * sizeof(int));
+		capture->stats.written = capture->lastWritten + 1;
+		capture->stats.encodeMs += (encodeMs - capture->stats.encodeMs) * 0.1f;
+	}
+}
+
+// Needs a window (GL context). `width` and `height` are the framebuffer size.
+static bool StartCapture(CaptureState *capture, int width, int height) {
+	if (!LoadCaptureGL(&capture->gl)) {
+		TraceLog(LOG_WARNING, "CAPTURE: pixel pack buffers not available, capture disabled");
+		return false;
+	}
+	
+	// 4:2:0 needs even dimensions
+	capture->width = width & ~1;
+	capture->height = height & ~1;
+	snprintf(capture->path, sizeof(capture->path), "capture_%lld.y4m", (long long)time(NULL));
+	capture->file = fopen(capture->path, "wb");
+	if (!capture->file) {
+		TraceLog(LOG_WARNING, "CAPTURE: cannot create %s", capture->path);
+		return false;
+	}
+	fprintf(capture->file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", capture->width, capture->height, CAPTURE_FPS);
+	
+	size_t frameSize = (size_t)capture->width * capture->height * 4;
+	for (int i = 0; i < CAPTURE_RING_SIZE; i++) {
+		CaptureSlot *slot = &capture->slots[i];
+		capture->gl.GenBuffers(1, &slot->buffer);
+		capture->gl.BindBuffer(CAPTURE_GL_PIXEL_PACK_BUFFER, slot->buffer);
+		capture->gl.BufferData(CAPTURE_GL_PIXEL_PACK_BUFFER, frameSize, NULL, CAPTURE_GL_STREAM_READ);
+		slot->state = CAPTURE_SLOT_FREE;
+		slot->pixels = NULL;
+	}
+	capture->gl.BindBuffer(CAPTURE_GL_PIXEL_PACK_BUFFER, 0);
+	
+	capture->yuv = (unsigned char *)malloc((size_t)capture->width * capture->height * 3/2);
+	capture->queueCount = 0;
+	capture->tick = 0;
+	capture->startTime = GetTime();
+	capture->nextFrame = 0;
+	capture->lastWritten = -1;
+	capture->quit = false;
+	capture->stats = (CaptureStats){0};
+	capture->encoder = std::thread(CaptureEncoderRun, capture);
+	capture->active = true;
+	
+	TraceLog(LOG_INFO, "CAPTURE: recording %dx%d at %d fps to %s", capture->width, capture->height, CAPTURE_FPS, capture->path);
+	return true;
+}
+
+// Unmaps what the encoder finished and hands over readbacks that are ready.
+// `flush` hands over every pending readback regardless of age.
+static void ServiceCaptureSlots(CaptureState *capture, bool flush) {
+	bool queued = false;
+	{
+		std::lock_guard<std::mutex> guard(capture->lock);
+		for (int i = 0; i < CAPTURE_RING_SIZE; i++) {
+			CaptureSlot *slot = &capture->slots[i];
+			if (slot->state == CAPTURE_SLOT_DONE) {
+				capture->gl.BindBuffer(CAPTURE_GL_PIXEL_PACK_BUFFER, slot->buffer);
+				capture->gl.UnmapBuffer(CAPTURE_GL_PIXEL_PACK_BUFFER);
+				slot->pixels = NULL;
+				slot->state = CAPTURE_SLOT_FREE;
+			}
+		}
+		
+		// Hand over in frame order so the encoder writes them in sequence
+		for (;;) {
+			CaptureSlot *oldest = NULL;
+			int oldestIndex = -1;
+			for (int i = 0; i < CAPTURE_RING_SIZE; i++) {
+				CaptureSlot *slot = &capture->slots[i];
+				if (slot->state == CAPTURE_SLOT_READING && (flush || capture->tick - slot->readTick >= CAPTURE_READBACK_DELAY) &&
+					(oldest == NULL || slot->frame < oldest->frame)) {
+					oldest = slot;
+					oldestIndex = i;
+				}
+			}
+			if (oldest == NULL) {
+				break;
+			}
+			
+			capture->gl.BindBuffer(CAPTURE_GL_PIXEL_PACK_BUFFER, oldest->buffer);
+			oldest->pixels = (const unsigned char *)capture->gl.MapBuffer(CAPTURE_GL_PIXEL_PACK_BUFFER, CAPTURE_GL_READ_ONLY);
+			if (oldest->pixels == NULL) {
+				oldest->state = CAPTURE_SLOT_FREE;
+				capture->stats.dropped++;
+				continue;
+			}
+			oldest->state = CAPTURE_SLOT_ENCODING;
+			capture->queue[capture->queueCount++] = oldestIndex;
+			queued = true;
+		}
+		capture->gl.BindBuffer(CAPTURE_GL_PIXEL_PACK_BUFFER, 0);
+	}
+	if (queued) {
+		capture->wake.notify_one();
+	}
+}
+
+// Call once per rendered frame after drawing and before EndDrawing(), while
+// the finished frame is still in the back buffer.
+static void CaptureFrame(CaptureState *capture, double now) {
+	if (!capture->active) {
+		return;
+	}
+	double start = GetTime();
+	capture->tick++;
+	ServiceCaptureSlots(capture, false);
+	
+	int frame = (int)((now - capture->startTime) * CAPTURE_FPS);
+	if (frame >= capture->nextFrame) {
+		capture->nextFrame = frame + 1;
+		
+		CaptureSlot *slot = NULL;
+		{
+			std::lock_guard<std::mutex> guard(capture->lock);
+			for (int i = 0; i < CAPTURE_RING_SIZE && slot == NULL; i++) {
+				if (capture->slots[i].state == CAPTURE_SLOT_FREE) {
+					slot = &capture->slots[i];
+				}
+			}
+			if (slot == NULL) {
+				capture->stats.dropped++;
+			}
+		}
+		
+		if (slot != NULL) {
+			// raylib batches draws; flush so the back buffer holds the whole frame
+			rlDrawRenderBatchActive();
+			capture->gl.BindBuffer(CAPTURE_GL_PIXEL_PACK_BUFFER, slot->buffer);
+			capture->gl.ReadPixels(0, 0, capture->width, capture->height, CAPTURE_GL_RGBA, CAPTURE_GL_UNSIGNED_BYTE, NULL);
+			capture->gl.BindBuffer(CAPTURE_GL_PIXEL_PACK_BUFFER, 0);
+			
+			std::lock_guard<std::mutex> guard(capture->lock);
+			slot->state = CAPTURE_SLOT_READING;
+			slot->frame = frame;
+			slot->readTick = capture->tick;
+			capture->stats.captured++;
+		}
+	}
+	
+	float overheadMs = (float)((GetTime() - start) * 1000.0);
+	std::lock_guard<std::mutex> guard(capture->lock);
+	capture->stats.overheadMs += (overheadMs - capture->stats.overheadMs) * 0.1f;
+}
+
+// Encodes whatever is still in flight, then releases everything.
+static void StopCapture(CaptureState *capture) {
+	if (!capture->active) {
+		return;
+	}
+	ServiceCaptureSlots(capture, true);
+	{
+		std::lock_guard<std::mutex> guard(capture->lock);
+		capture->quit = true;
+	}
+	capture->wake.notify_one();
+	capture->encoder.join();
+	ServiceCaptureSlots(capture, true);
+	
+	for (int i = 0; i < CAPTURE_RING_SIZE; i++) {
+		capture->gl.DeleteBuffers(1, &capture->slots[i].buffer);
+	}
+	fclose(capture->file);
+	free(capture->yuv);
+	capture->yuv = NULL;
+	capture->active = false;
+	
+	TraceLog(LOG_INFO, "CAPTURE: %s closed, %d frames captured, %d dropped, %d written, %.2f ms/frame on the game thread",
+			 capture->path, capture->stats.captured, capture->stats.dropped, capture->stats.written, capture->stats.overheadMs);
+}
+
+static CaptureStats GetCaptureStats(CaptureState *capture) {
+	std::lock_guard<std::mutex> guard(capture->lock);
+	return capture->stats;
+}
+
+#endif // CAPTURE_H
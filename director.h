@@ -0,0 +1,78 @@
+#ifndef DIRECTOR_H
+#define DIRECTOR_H
+
+// Frame-budget-aware spawn director.
+//
+// Watches the measured CPU cost of simulating and drawing each tick and scales
+// spawn density to stay inside a frame budget. Density only takes the values
+// 1, 1/2, 1/3 and 1/4: at 1/n the spawn interval is n times longer and every
+// enemy that does spawn has n times the health and score. Because n is an
+// integer the scaling is exact, so damage needed per second and score per
+// second match the authored rate and timed-mode results do not depend on how
+// fast the machine is.
+
+#define DIRECTOR_BUDGET_MS 10.0f		// sim + draw target, leaves headroom in a 16.7 ms frame
+#define DIRECTOR_RELAX_RATIO 0.6f		// cost below budget * ratio lets density climb back
+#define DIRECTOR_SMOOTHING 0.1f			// EMA weight of the newest sample
+#define DIRECTOR_DECISION_INTERVAL 0.5f	// seconds between adjustments
+#define DIRECTOR_MAX_THINNING 4			// lowest density is 1/4
+#define DIRECTOR_SIMPLE_PATTERN_THINNING 3
+
+typedef struct {
+	float simMs;			// smoothed cost of UpdateGame
+	float drawMs;			// smoothed cost of DrawGame
+	int thinning;			// 1 = authored spawn rate, n = 1/n as many enemies, n times tougher
+	float density;			// 1.0f / thinning, for display and telemetry
+	int patternBullets;		// bullets per boss volley
+	float decisionTimer;
+	int adjustments;
+} SpawnDirector;
+
+static void ResetDirector(SpawnDirector *director) {
+	director->thinning = 1;
+	director->density = 1.0f;
+	director->patternBullets = 3;
+	director->decisionTimer = 0.0f;
+}
+
+// Feeds one tick of measurements. Returns true when the director changed its
+// decision so the caller can log it.
+static bool UpdateDirector(SpawnDirector *director, float simMs, float drawMs, float dt) {
+	director->simMs += (simMs - director->simMs) * DIRECTOR_SMOOTHING;
+	director->drawMs += (drawMs - director->drawMs) * DIRECTOR_SMOOTHING;
+	
+	director->decisionTimer += dt;
+	if (director->decisionTimer < DIRECTOR_DECISION_INTERVAL) {
+		return false;
+	}
+	director->decisionTimer = 0.0f;
+	
+	float cost = director->simMs + director->drawMs;
+	int thinning = director->thinning;
+	if (cost > DIRECTOR_BUDGET_MS && thinning < DIRECTOR_MAX_THINNING) {
+		thinning++;
+	} else if (cost < DIRECTOR_BUDGET_MS * DIRECTOR_RELAX_RATIO && thinning > 1) {
+		thinning--;
+	}
+	if (thinning == director->thinning) {
+		return false;
+	}
+	
+	// Under heavy pressure the boss fires one big shot carrying the whole
+	// volley's damage instead of a spread.
+	director->thinning = thinning;
+	director->density = 1.0f / thinning;
+	director->patternBullets = (thinning >= DIRECTOR_SIMPLE_PATTERN_THINNING) ? 1 : 3;
+	director->adjustments++;
+	return true;
+}
+
+static float DirectorSpawnInterval(const SpawnDirector *director, float interval) {
+	return interval * director->thinning;
+}
+
+static int DirectorScale(const SpawnDirector *director, int value) {
+	return value * director->thinning;
+}
+
+#endif // DIRECTOR_H
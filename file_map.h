@@ -0,0 +1,158 @@
+#ifndef FILE_MAP_H
+#define FILE_MAP_H
+
+// Tiny cross-platform wrapper around mmap / MapViewOfFile.
+// Deliberately does not depend on raylib so the offline tools can use it too.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(_WIN32)
+	// Keep windows.h from clashing with raylib (Rectangle, CloseWindow, DrawText...)
+	#define NOGDI
+	#define NOUSER
+	#define NOMINMAX
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+	#undef near
+	#undef far
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+typedef struct {
+	void *data;
+	size_t size;
+	bool writable;
+#if defined(_WIN32)
+	HANDLE file;
+	HANDLE mapping;
+#else
+	int fd;
+#endif
+} MappedFile;
+
+// Maps an existing file read-only. Returns false (and a zeroed map) if the file
+// is missing or empty.
+static inline bool MapFileRead(MappedFile *map, const char *path) {
+	memset(map, 0, sizeof(*map));
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	void *data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+	if (!data) {
+		if (mapping) {
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		return false;
+	}
+	map->file = file;
+	map->mapping = mapping;
+	map->size = (size_t)size.QuadPart;
+#else
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		return false;
+	}
+	void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (data == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+	map->fd = fd;
+	map->size = (size_t)st.st_size;
+#endif
+	map->data = data;
+	map->writable = false;
+	return true;
+}
+
+// Opens (creating if needed) a file of exactly `size` bytes and maps it
+// read/write. Existing contents are preserved when the size already matches.
+static inline bool MapFileReadWrite(MappedFile *map, const char *path, size_t size) {
+	memset(map, 0, sizeof(*map));
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)(size & 0xFFFFFFFFu), NULL);
+	void *data = mapping ? MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size) : NULL;
+	if (!data) {
+		if (mapping) {
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		return false;
+	}
+	map->file = file;
+	map->mapping = mapping;
+#else
+	int fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || ((size_t)st.st_size != size && ftruncate(fd, (off_t)size) != 0)) {
+		close(fd);
+		return false;
+	}
+	void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (data == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+	map->fd = fd;
+#endif
+	map->data = data;
+	map->size = size;
+	map->writable = true;
+	return true;
+}
+
+// Asks the OS to start writing dirty pages back. Never called on the hot path.
+static inline void FlushMappedFile(MappedFile *map) {
+	if (!map->data || !map->writable) {
+		return;
+	}
+#if defined(_WIN32)
+	FlushViewOfFile(map->data, 0);
+#else
+	msync(map->data, map->size, MS_ASYNC);
+#endif
+}
+
+static inline void UnmapFile(MappedFile *map) {
+	if (!map->data) {
+		return;
+	}
+#if defined(_WIN32)
+	UnmapViewOfFile(map->data);
+	CloseHandle(map->mapping);
+	CloseHandle(map->file);
+#else
+	munmap(map->data, map->size);
+	close(map->fd);
+#endif
+	memset(map, 0, sizeof(*map));
+}
+
+#endif // FILE_MAP_H
@@ -0,0 +1,117 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+// Buffered, timestamped key presses and the frame pacing that samples them.
+//
+// raylib only reports a key edge if the key is still down at the next poll, so
+// a tap that starts and ends between two polls is lost by IsKeyPressed. Its
+// key-pressed queue does see every press, but is cleared on each poll. Every
+// poll is therefore followed by CollectInputEvents(), which moves the presses
+// into our own queue stamped with the poll time. Each tick then consumes
+// everything buffered since the previous tick, so every press is applied.
+
+#include <string.h>
+#include "raylib.h"
+
+#define INPUT_QUEUE_SIZE 64
+#define INPUT_POLL_INTERVAL 0.002		// seconds between polls while the frame waits, see WaitSamplingInput()
+#define LATENCY_HISTORY 64
+
+typedef struct {
+	int key;
+	double time;		// when the press was first observed
+} InputEvent;
+
+typedef struct {
+	InputEvent pending[INPUT_QUEUE_SIZE];	// buffered since the last tick
+	int pendingCount;
+	InputEvent tick[INPUT_QUEUE_SIZE];		// being applied by the current tick
+	int tickCount;
+	int dropped;
+} InputQueue;
+
+typedef struct {
+	float history[LATENCY_HISTORY];		// input-to-present, ms
+	int next;
+	int count;
+	float lastMs;
+} LatencyStats;
+
+static void PushInputEvent(InputQueue *queue, int key, double time) {
+	if (queue->pendingCount == INPUT_QUEUE_SIZE) {
+		queue->dropped++;
+		return;
+	}
+	queue->pending[queue->pendingCount++] = (InputEvent){ key, time };
+}
+
+// Call right after anything that polls (EndDrawing, PollInputEvents).
+static void CollectInputEvents(InputQueue *queue, double now) {
+	for (int key = GetKeyPressed(); key != 0; key = GetKeyPressed()) {
+		PushInputEvent(queue, key, now);
+	}
+}
+
+// Hands everything buffered so far to the tick that is about to run.
+static void BeginInputTick(InputQueue *queue) {
+	memcpy(queue->tick, queue->pending, queue->pendingCount * sizeof(InputEvent));
+	queue->tickCount = queue->pendingCount;
+	queue->pendingCount = 0;
+}
+
+static int InputPressCount(const InputQueue *queue, int key) {
+	int count = 0;
+	for (int i = 0; i < queue->tickCount; i++) {
+		if (queue->tick[i].key == key) {
+			count++;
+		}
+	}
+	return count;
+}
+
+static bool InputPressed(const InputQueue *queue, int key) {
+	return InputPressCount(queue, key) > 0;
+}
+
+// Sleeps until `until` in short slices, polling in between so presses get an
+// accurate timestamp instead of the time of the next frame's poll.
+//
+// raylib's WaitTime() sleeps for 95% of the request in whole milliseconds and
+// busy-waits the rest. On Windows a 1 ms slice becomes Sleep(0) plus a spin,
+// which would keep a core at 100% for every idle part of the frame. 2 ms slices
+// sleep for real, so only the final sub-slice before the deadline spins.
+static void WaitSamplingInput(InputQueue *queue, double until) {
+	for (;;) {
+		double remaining = until - GetTime();
+		if (remaining <= 0.0) {
+			break;
+		}
+		WaitTime((remaining < INPUT_POLL_INTERVAL) ? remaining : INPUT_POLL_INTERVAL);
+		PollInputEvents();
+		CollectInputEvents(queue, GetTime());
+	}
+}
+
+static void RecordLatency(LatencyStats *stats, float ms) {
+	stats->history[stats->next] = ms;
+	stats->next = (stats->next + 1) % LATENCY_HISTORY;
+	if (stats->count < LATENCY_HISTORY) {
+		stats->count++;
+	}
+	stats->lastMs = ms;
+}
+
+static void LatencySummary(const LatencyStats *stats, float *avgMs, float *maxMs) {
+	float sum = 0.0f;
+	float max = 0.0f;
+	for (int i = 0; i < stats->count; i++) {
+		sum += stats->history[i];
+		if (stats->history[i] > max) {
+			max = stats->history[i];
+		}
+	}
+	*avgMs = (stats->count > 0) ? sum / stats->count : 0.0f;
+	*maxMs = max;
+}
+
+#endif // INPUT_H
@@ -0,0 +1,249 @@
+#ifndef KDTREE_H
+#define KDTREE_H
+
+// 2-d tree over target positions for nearest, k-nearest and radius queries.
+//
+// The tree is implicit: BuildKdTree() reorders the point array so that the
+// median of every range is its node (split on x at even depths, y at odd),
+// with the left half before it and the right half after. There are no node
+// pointers to allocate, and rebuilding from scratch every tick is just a few
+// nth_element passes over a flat array, which is cheaper than keeping a
+// dynamic tree up to date as everything moves. Ranges of KD_LEAF_SIZE points
+// or fewer are left unsorted and scanned, which beats descending that last
+// few levels; below that size the whole tree is one flat scan.
+
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+#include "raylib.h"
+
+#define KD_MAX_POINTS 1024
+#define KD_MAX_K 8
+#define KD_LEAF_SIZE 32
+
+typedef struct {
+	Vector2 position;
+	int id;					// caller's index, e.g. into enemies[]
+} KdPoint;
+
+typedef struct {
+	int id;
+	float distanceSq;
+} KdResult;
+
+typedef struct {
+	float minX;
+	float minY;
+	float maxX;
+	float maxY;
+} KdBounds;
+
+typedef struct {
+	KdPoint points[KD_MAX_POINTS];
+	int count;
+	KdBounds bounds;		// of every point, set by BuildKdTree()
+	uint64_t visited;		// nodes touched by queries, for benchmarking
+} KdTree;
+
+static void ResetKdTree(KdTree *tree) {
+	tree->count = 0;
+}
+
+static void KdTreeAdd(KdTree *tree, Vector2 position, int id) {
+	if (tree->count < KD_MAX_POINTS) {
+		tree->points[tree->count++] = (KdPoint){ position, id };
+	}
+}
+
+static void KdBuildRange(KdPoint *points, int lo, int hi, int axis) {
+	if (hi - lo <= KD_LEAF_SIZE) {
+		return;
+	}
+	int mid = (lo + hi) / 2;
+	if (axis) {
+		std::nth_element(points + lo, points + mid, points + hi, [](const KdPoint &a, const KdPoint &b) { return a.position.y < b.position.y; });
+	} else {
+		std::nth_element(points + lo, points + mid, points + hi, [](const KdPoint &a, const KdPoint &b) { return a.position.x < b.position.x; });
+	}
+	KdBuildRange(points, lo, mid, axis ^ 1);
+	KdBuildRange(points, mid + 1, hi, axis ^ 1);
+}
+
+// Call after adding every point, before querying.
+static void BuildKdTree(KdTree *tree) {
+	KdBounds bounds = { 0.0f, 0.0f, 0.0f, 0.0f };
+	if (tree->count > 0) {
+		bounds = (KdBounds){ tree->points[0].position.x, tree->points[0].position.y,
+							 tree->points[0].position.x, tree->points[0].position.y };
+	}
+	for (int i = 1; i < tree->count; i++) {
+		bounds.minX = fminf(bounds.minX, tree->points[i].position.x);
+		bounds.minY = fminf(bounds.minY, tree->points[i].position.y);
+		bounds.maxX = fmaxf(bounds.maxX, tree->points[i].position.x);
+		bounds.maxY = fmaxf(bounds.maxY, tree->points[i].position.y);
+	}
+	tree->bounds = bounds;
+	KdBuildRange(tree->points, 0, tree->count, 0);
+}
+
+static inline float KdDistanceSq(Vector2 a, Vector2 b) {
+	float dx = a.x - b.x;
+	float dy = a.y - b.y;
+	return dx*dx + dy*dy;
+}
+
+// Keeps best[] sorted nearest first, at most k long.
+static inline void KdOffer(const KdPoint *point, Vector2 target, KdResult *best, int k, int *found) {
+	float distanceSq = KdDistanceSq(point->position, target);
+	if (*found < k || distanceSq < best[*found - 1].distanceSq) {
+		int slot = (*found < k) ? (*found)++ : k - 1;
+		while (slot > 0 && best[slot - 1].distanceSq > distanceSq) {
+			best[slot] = best[slot - 1];
+			slot--;
+		}
+		best[slot] = (KdResult){ point->id, distanceSq };
+	}
+}
+
+static void KdSearch(KdTree *tree, int lo, int hi, int axis, Vector2 target, KdResult *best, int k, int *found) {
+	if (hi - lo <= KD_LEAF_SIZE) {
+		for (int i = lo; i < hi; i++) {
+			KdOffer(&tree->points[i], target, best, k, found);
+		}
+		tree->visited += hi - lo;
+		return;
+	}
+	int mid = (lo + hi) / 2;
+	const KdPoint *node = &tree->points[mid];
+	tree->visited++;
+	KdOffer(node, target, best, k, found);
+	
+	// Descend into the side holding the target first; the other side only
+	// matters if the splitting line is closer than the current worst result.
+	float delta = axis ? target.y - node->position.y : target.x - node->position.x;
+	if (delta < 0.0f) {
+		KdSearch(tree, lo, mid, axis ^ 1, target, best, k, found);
+		if (*found < k || delta*delta < best[*found - 1].distanceSq) {
+			KdSearch(tree, mid + 1, hi, axis ^ 1, target, best, k, found);
+		}
+	} else {
+		KdSearch(tree, mid + 1, hi, axis ^ 1, target, best, k, found);
+		if (*found < k || delta*delta < best[*found - 1].distanceSq) {
+			KdSearch(tree, lo, mid, axis ^ 1, target, best, k, found);
+		}
+	}
+}
+
+// Single-result version of KdSearch: the running best is one index and one
+// distance, so leaves are a plain minimum scan.
+static void KdSearchNearest(KdTree *tree, int lo, int hi, int axis, Vector2 target, int *best, float *bestDistanceSq) {
+	if (hi - lo <= KD_LEAF_SIZE) {
+		for (int i = lo; i < hi; i++) {
+			float distanceSq = KdDistanceSq(tree->points[i].position, target);
+			if (distanceSq < *bestDistanceSq) {
+				*bestDistanceSq = distanceSq;
+				*best = i;
+			}
+		}
+		tree->visited += hi - lo;
+		return;
+	}
+	int mid = (lo + hi) / 2;
+	const KdPoint *node = &tree->points[mid];
+	tree->visited++;
+	float distanceSq = KdDistanceSq(node->position, target);
+	if (distanceSq < *bestDistanceSq) {
+		*bestDistanceSq = distanceSq;
+		*best = mid;
+	}
+	
+	float delta = axis ? target.y - node->position.y : target.x - node->position.x;
+	int nearLo = (delta < 0.0f) ? lo : mid + 1;
+	int nearHi = (delta < 0.0f) ? mid : hi;
+	KdSearchNearest(tree, nearLo, nearHi, axis ^ 1, target, best, bestDistanceSq);
+	if (delta*delta < *bestDistanceSq) {
+		KdSearchNearest(tree, (delta < 0.0f) ? mid + 1 : lo, (delta < 0.0f) ? hi : mid, axis ^ 1, target, best, bestDistanceSq);
+	}
+}
+
+// Returns the id of the closest point, or -1 if the tree is empty.
+static int KdNearest(KdTree *tree, Vector2 target) {
+	int best = -1;
+	float bestDistanceSq = INFINITY;
+	KdSearchNearest(tree, 0, tree->count, 0, target, &best, &bestDistanceSq);
+	return (best >= 0) ? tree->points[best].id : -1;
+}
+
+// Fills out[] with up to k (at most KD_MAX_K) closest points, nearest first.
+static int KdKNearest(KdTree *tree, Vector2 target, int k, KdResult *out) {
+	int found = 0;
+	KdSearch(tree, 0, tree->count, 0, target, out, (k < KD_MAX_K) ? k : KD_MAX_K, &found);
+	return found;
+}
+
+// Squared distance from the target to the farthest corner of a cell.
+static inline float KdFarthestSq(KdBounds cell, Vector2 target) {
+	float dx = fmaxf(target.x - cell.minX, cell.maxX - target.x);
+	float dy = fmaxf(target.y - cell.minY, cell.maxY - target.y);
+	return dx*dx + dy*dy;
+}
+
+// `cell` bounds every point in [lo, hi). A bomb-sized radius swallows whole
+// cells, which are then copied out without a distance test per point, and
+// leaves write unconditionally and only advance past hits, so the scan does
+// not branch on each point.
+static void KdRadiusRange(KdTree *tree, int lo, int hi, int axis, KdBounds cell, Vector2 target, float radiusSq,
+						  int *out, int capacity, int *found) {
+	if (*found + (hi - lo) <= capacity && KdFarthestSq(cell, target) < radiusSq) {
+		for (int i = lo; i < hi; i++) {
+			out[(*found)++] = tree->points[i].id;
+		}
+		tree->visited++;
+		return;
+	}
+	if (hi - lo <= KD_LEAF_SIZE) {
+		int count = *found;
+		for (int i = lo; i < hi && count < capacity; i++) {
+			out[count] = tree->points[i].id;
+			count += KdDistanceSq(tree->points[i].position, target) < radiusSq;
+		}
+		*found = count;
+		tree->visited += hi - lo;
+		return;
+	}
+	int mid = (lo + hi) / 2;
+	const KdPoint *node = &tree->points[mid];
+	tree->visited++;
+	
+	if (KdDistanceSq(node->position, target) < radiusSq && *found < capacity) {
+		out[(*found)++] = node->id;
+	}
+	
+	float split = axis ? node->position.y : node->position.x;
+	float delta = axis ? target.y - split : target.x - split;
+	KdBounds below = cell;
+	KdBounds above = cell;
+	if (axis) {
+		below.maxY = split;
+		above.minY = split;
+	} else {
+		below.maxX = split;
+		above.minX = split;
+	}
+	if (delta < 0.0f || delta*delta < radiusSq) {
+		KdRadiusRange(tree, lo, mid, axis ^ 1, below, target, radiusSq, out, capacity, found);
+	}
+	if (delta >= 0.0f || delta*delta < radiusSq) {
+		KdRadiusRange(tree, mid + 1, hi, axis ^ 1, above, target, radiusSq, out, capacity, found);
+	}
+}
+
+// Fills out[] with the ids of every point strictly within `radius`, in no
+// particular order. Returns how many were written.
+static int KdRadius(KdTree *tree, Vector2 target, float radius, int *out, int capacity) {
+	int found = 0;
+	KdRadiusRange(tree, 0, tree->count, 0, tree->bounds, target, radius*radius, out, capacity, &found);
+	return found;
+}
+
+#endif // KDTREE_H
@@ -0,0 +1,223 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+// Hardware performance counters around named code phases, for the benchmark.
+//
+// On Linux the counters are one perf_event_open group (cycles leading,
+// instructions, L1D read misses, last-level cache misses, branch misses)
+// counting user space of the calling thread only. They are read as a group,
+// so every phase sees all five over exactly the same window. Events the CPU
+// or hypervisor does not expose are left out individually. If the group
+// cannot be opened at all (no PMU, perf_event_paranoid, not Linux) phases
+// are still timed, just without counters.
+//
+// Phases do nothing until OpenPerfCounters() has been called, so hooks can
+// stay in the game loop for free.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#if defined(__linux__)
+	#include <errno.h>
+	#include <linux/perf_event.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+typedef enum {
+	PERF_CYCLES,
+	PERF_INSTRUCTIONS,
+	PERF_L1D_MISSES,
+	PERF_LLC_MISSES,
+	PERF_BRANCH_MISSES,
+	PERF_COUNTER_COUNT
+} PerfCounter;
+
+static const char *perfCounterNames[PERF_COUNTER_COUNT] = { "cycles", "instr", "L1D miss", "LLC miss", "br miss" };
+
+typedef struct {
+	bool timing;			// phases are measured at all
+	bool available;			// hardware counters are running
+	int fds[PERF_COUNTER_COUNT];	// -1 where the event could not be opened
+	uint64_t ids[PERF_COUNTER_COUNT];
+	uint64_t timeEnabled;	// from the latest read; running < enabled means multiplexed
+	uint64_t timeRunning;
+	char error[128];		// why counters are unavailable
+} PerfCounters;
+
+typedef struct {
+	double seconds;
+	uint64_t values[PERF_COUNTER_COUNT];
+} PerfSample;
+
+typedef struct {
+	const char *name;
+	PerfSample total;
+	PerfSample start;
+	uint64_t ticks;
+	uint64_t entityTicks;	// entities processed, summed over ticks; filled in by the caller
+} PerfPhase;
+
+static double PerfNow(void) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if defined(__linux__)
+static int OpenPerfEvent(uint32_t type, uint64_t config, int groupFd) {
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.disabled = (groupFd == -1);	// the leader starts the whole group
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	return (int)syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+#endif
+
+// Enables phase timing and, if `hardware` is set, tries to start the
+// counters. Returns whether they are running; if not, counters->error says
+// why and phases are timed only.
+static bool OpenPerfCounters(PerfCounters *counters, bool hardware) {
+	memset(counters, 0, sizeof(*counters));
+	counters->timing = true;
+	for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+		counters->fds[i] = -1;
+	}
+	if (!hardware) {
+		snprintf(counters->error, sizeof(counters->error), "counters not requested");
+		return false;
+	}
+#if defined(__linux__)
+	static const struct {
+		uint32_t type;
+		uint64_t config;
+	} events[PERF_COUNTER_COUNT] = {
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+	};
+	
+	int leader = OpenPerfEvent(events[PERF_CYCLES].type, events[PERF_CYCLES].config, -1);
+	if (leader < 0) {
+		snprintf(counters->error, sizeof(counters->error), "perf_event_open: %s%s", strerror(errno),
+				 (errno == EACCES || errno == EPERM) ? " (check /proc/sys/kernel/perf_event_paranoid)" :
+				 (errno == ENOENT || errno == EOPNOTSUPP) ? " (no hardware PMU, e.g. in a VM)" : "");
+		return false;
+	}
+	counters->fds[PERF_CYCLES] = leader;
+	for (int i = PERF_CYCLES + 1; i < PERF_COUNTER_COUNT; i++) {
+		counters->fds[i] = OpenPerfEvent(events[i].type, events[i].config, leader);
+	}
+	for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+		if (counters->fds[i] >= 0 && ioctl(counters->fds[i], PERF_EVENT_IOC_ID, &counters->ids[i]) < 0) {
+			close(counters->fds[i]);
+			counters->fds[i] = -1;
+		}
+	}
+	if (counters->fds[PERF_CYCLES] < 0) {
+		snprintf(counters->error, sizeof(counters->error), "cannot identify the counter group");
+		return false;
+	}
+	ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	counters->available = true;
+	return true;
+#else
+	snprintf(counters->error, sizeof(counters->error), "hardware counters need Linux perf_event_open");
+	return false;
+#endif
+}
+
+static void ClosePerfCounters(PerfCounters *counters) {
+#if defined(__linux__)
+	for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+		if (counters->fds[i] >= 0) {
+			close(counters->fds[i]);
+		}
+		counters->fds[i] = -1;
+	}
+#endif
+	counters->available = false;
+	counters->timing = false;
+}
+
+static void ReadPerfSample(PerfCounters *counters, PerfSample *sample) {
+#if defined(__linux__)
+	if (counters->available) {
+		// { nr, time_enabled, time_running, { value, id }[nr] }
+		uint64_t data[3 + 2*PERF_COUNTER_COUNT];
+		if (read(counters->fds[PERF_CYCLES], data, sizeof(data)) > 0) {
+			counters->timeEnabled = data[1];
+			counters->timeRunning = data[2];
+			for (uint64_t n = 0; n < data[0] && n < PERF_COUNTER_COUNT; n++) {
+				for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+					if (counters->fds[i] >= 0 && counters->ids[i] == data[4 + 2*n]) {
+						sample->values[i] = data[3 + 2*n];
+					}
+				}
+			}
+		}
+	}
+#endif
+	sample->seconds = PerfNow();
+}
+
+static void BeginPerfPhase(PerfCounters *counters, PerfPhase *phase) {
+	if (counters->timing) {
+		ReadPerfSample(counters, &phase->start);
+	}
+}
+
+static void EndPerfPhase(PerfCounters *counters, PerfPhase *phase) {
+	if (!counters->timing) {
+		return;
+	}
+	PerfSample end = phase->start;
+	ReadPerfSample(counters, &end);
+	phase->total.seconds += end.seconds - phase->start.seconds;
+	for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+		phase->total.values[i] += end.values[i] - phase->start.values[i];
+	}
+	phase->ticks++;
+}
+
+static void ResetPerfPhase(PerfPhase *phase) {
+	const char *name = phase->name;
+	memset(phase, 0, sizeof(*phase));
+	phase->name = name;
+}
+
+// One line per phase, everything divided down to a single entity for a
+// single tick so different entity counts can be compared directly.
+static void PrintPerfPhase(const PerfCounters *counters, const PerfPhase *phase) {
+	if (phase->ticks == 0 || phase->entityTicks == 0) {
+		printf("      %-10s no entities\n", phase->name);
+		return;
+	}
+	double perEntity = 1.0 / phase->entityTicks;
+	printf("      %-10s %6.1f entities | %6.1f ns", phase->name, (double)phase->entityTicks / phase->ticks,
+		   phase->total.seconds * 1e9 * perEntity);
+	if (counters->available) {
+		for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+			if (counters->fds[i] >= 0) {
+				printf(" | %7.2f %s", phase->total.values[i] * perEntity, perfCounterNames[i]);
+			} else {
+				printf(" |     n/a %s", perfCounterNames[i]);
+			}
+		}
+		if (phase->total.values[PERF_CYCLES] > 0) {
+			printf(" | IPC %.2f", (double)phase->total.values[PERF_INSTRUCTIONS] / phase->total.values[PERF_CYCLES]);
+		}
+	}
+	printf("\n");
+}
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,271 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+// Persistent player profile: per-mode leaderboards and achievement progress.
+//
+// On disk the profile is a small header followed by a ProfileData block.
+// Fields are only ever appended to ProfileData, so a newer build can load an
+// older file by copying the prefix it has and zeroing the rest. An older build
+// loading a newer file reads the prefix it knows and keeps the rest as an
+// opaque tail that every save writes back, so it never drops a newer build's
+// fields. A tail too large to keep makes the profile read-only instead.
+//
+// Loading maps the file once. Saving hands a snapshot to a background thread
+// which writes it to a temp file, syncs it and renames it over the old one, so
+// a crash mid-save leaves either the old or the new profile, never a torn one.
+
+#include <stdio.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "file_map.h"
+
+#if defined(_WIN32)
+	#include <io.h>
+#endif
+
+#define PROFILE_MAGIC 0x4C465250u // "PRFL"
+#define PROFILE_VERSION 1
+#define PROFILE_FILE "profile.bin"
+#define PROFILE_TEMP_FILE "profile.bin.tmp"
+#define PROFILE_MODE_COUNT 2
+#define LEADERBOARD_SIZE 10
+#define PROFILE_MAX_TAIL 4096
+
+typedef struct {
+	int32_t score;
+	int32_t level;
+	int64_t timestamp;		// seconds since the epoch
+} LeaderboardEntry;
+
+typedef struct {
+	int32_t count;
+	int32_t reserved;
+	LeaderboardEntry entries[LEADERBOARD_SIZE];	// best first
+} Leaderboard;
+
+// Version 1 layout. Append new fields at the end and bump PROFILE_VERSION.
+typedef struct {
+	Leaderboard leaderboards[PROFILE_MODE_COUNT];	// indexed by GameMode
+	int32_t gamesPlayed;
+	uint8_t pilotAchieved;
+	uint8_t hobbyistAchieved;
+	uint8_t reserved[2];
+} ProfileData;
+
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t headerSize;
+	uint32_t dataSize;
+	uint32_t checksum;		// FNV-1a over the data block
+} ProfileHeader;
+
+static_assert(sizeof(ProfileHeader) == 16, "profile header layout changed");
+static_assert(sizeof(ProfileData) == 2*(8 + 16*LEADERBOARD_SIZE) + 8, "profile data layout changed");
+
+// Data from a newer build past the end of this build's ProfileData. Set once
+// by LoadProfile() before the saver starts, then only read by it.
+typedef struct {
+	uint16_t version;
+	uint32_t size;
+	bool readOnly;			// the tail did not fit, so saving would lose it
+	uint8_t bytes[PROFILE_MAX_TAIL];
+} ProfileTail;
+
+static ProfileTail profileTail;
+
+typedef struct {
+	std::thread worker;
+	std::mutex lock;
+	std::condition_variable wake;
+	ProfileData pending;
+	bool hasPending;
+	bool quit;
+	int failedSaves;
+} ProfileSaver;
+
+static uint32_t ProfileChecksum(const void *data, size_t size) {
+	const uint8_t *bytes = (const uint8_t *)data;
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+// Inserts a score keeping the board sorted. Returns the 0-based rank, or -1 if
+// the score did not make the board.
+static int LeaderboardInsert(Leaderboard *board, int score, int level, int64_t timestamp) {
+	int rank = board->count;
+	while (rank > 0 && board->entries[rank - 1].score < score) {
+		rank--;
+	}
+	if (rank >= LEADERBOARD_SIZE) {
+		return -1;
+	}
+	
+	int last = (board->count < LEADERBOARD_SIZE) ? board->count : LEADERBOARD_SIZE - 1;
+	memmove(&board->entries[rank + 1], &board->entries[rank], (last - rank)*sizeof(LeaderboardEntry));
+	board->entries[rank] = (LeaderboardEntry){ score, level, timestamp };
+	if (board->count < LEADERBOARD_SIZE) {
+		board->count++;
+	}
+	return rank;
+}
+
+static int LeaderboardBest(const Leaderboard *board) {
+	return (board->count > 0) ? board->entries[0].score : 0;
+}
+
+static bool LoadProfileFile(ProfileData *profile, const char *path) {
+	MappedFile file;
+	if (!MapFileRead(&file, path)) {
+		return false;
+	}
+	
+	const ProfileHeader *header = (const ProfileHeader *)file.data;
+	const uint8_t *data = (const uint8_t *)file.data + sizeof(ProfileHeader);
+	bool valid = file.size >= sizeof(ProfileHeader) &&
+				 header->magic == PROFILE_MAGIC &&
+				 header->version >= 1 &&
+				 header->headerSize == sizeof(ProfileHeader) &&
+				 file.size >= sizeof(ProfileHeader) + header->dataSize &&
+				 ProfileChecksum(data, header->dataSize) == header->checksum;
+	
+	if (valid) {
+		size_t size = (header->dataSize < sizeof(ProfileData)) ? header->dataSize : sizeof(ProfileData);
+		memset(profile, 0, sizeof(*profile));
+		memcpy(profile, data, size);
+		
+		memset(&profileTail, 0, sizeof(profileTail));
+		size_t tail = header->dataSize - size;
+		if (tail > PROFILE_MAX_TAIL) {
+			profileTail.readOnly = true;
+		} else if (tail > 0) {
+			profileTail.version = header->version;
+			profileTail.size = (uint32_t)tail;
+			memcpy(profileTail.bytes, data + size, tail);
+		}
+	}
+	
+	UnmapFile(&file);
+	return valid;
+}
+
+// Falls back to the temp file (a save that was synced but not yet renamed)
+// and finally to an empty profile.
+static bool LoadProfile(ProfileData *profile) {
+	if (LoadProfileFile(profile, PROFILE_FILE)) {
+		return true;
+	}
+	if (LoadProfileFile(profile, PROFILE_TEMP_FILE)) {
+		return true;
+	}
+	memset(profile, 0, sizeof(*profile));
+	return false;
+}
+
+// Writes this build's fields followed by any tail kept from a newer build,
+// under the newer build's version number.
+static bool WriteProfileFile(const ProfileData *profile) {
+	if (profileTail.readOnly) {
+		return false;
+	}
+	uint8_t data[sizeof(ProfileData) + PROFILE_MAX_TAIL];
+	memcpy(data, profile, sizeof(ProfileData));
+	memcpy(data + sizeof(ProfileData), profileTail.bytes, profileTail.size);
+	uint32_t dataSize = sizeof(ProfileData) + profileTail.size;
+	
+	ProfileHeader header = {
+		.magic = PROFILE_MAGIC,
+		.version = (profileTail.version > PROFILE_VERSION) ? profileTail.version : (uint16_t)PROFILE_VERSION,
+		.headerSize = sizeof(ProfileHeader),
+		.dataSize = dataSize,
+		.checksum = ProfileChecksum(data, dataSize)
+	};
+	
+	FILE *file = fopen(PROFILE_TEMP_FILE, "wb");
+	if (!file) {
+		return false;
+	}
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+			  fwrite(data, dataSize, 1, file) == 1 &&
+			  fflush(file) == 0;
+#if defined(_WIN32)
+	ok = ok && _commit(_fileno(file)) == 0;
+#else
+	ok = ok && fsync(fileno(file)) == 0;
+#endif
+	ok = (fclose(file) == 0) && ok;
+	if (!ok) {
+		return false;
+	}
+
+#if defined(_WIN32)
+	return MoveFileExA(PROFILE_TEMP_FILE, PROFILE_FILE, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	if (rename(PROFILE_TEMP_FILE, PROFILE_FILE) != 0) {
+		return false;
+	}
+	int dir = open(".", O_RDONLY);
+	if (dir >= 0) {
+		fsync(dir);
+		close(dir);
+	}
+	return true;
+#endif
+}
+
+static void ProfileSaverRun(ProfileSaver *saver) {
+	std::unique_lock<std::mutex> guard(saver->lock);
+	for (;;) {
+		saver->wake.wait(guard, [saver] { return saver->hasPending || saver->quit; });
+		if (!saver->hasPending) {
+			break;
+		}
+		
+		// Only the newest snapshot matters; older queued ones were overwritten.
+		ProfileData snapshot = saver->pending;
+		saver->hasPending = false;
+		guard.unlock();
+		bool ok = WriteProfileFile(&snapshot);
+		guard.lock();
+		if (!ok) {
+			saver->failedSaves++;
+		}
+	}
+}
+
+static void ProfileSaverStart(ProfileSaver *saver) {
+	saver->hasPending = false;
+	saver->quit = false;
+	saver->failedSaves = 0;
+	saver->worker = std::thread(ProfileSaverRun, saver);
+}
+
+// Queues a snapshot for writing. Costs one short lock and a ~350 byte copy.
+static void ProfileSaveAsync(ProfileSaver *saver, const ProfileData *profile) {
+	{
+		std::lock_guard<std::mutex> guard(saver->lock);
+		saver->pending = *profile;
+		saver->hasPending = true;
+	}
+	saver->wake.notify_one();
+}
+
+// Writes any queued snapshot and joins the worker.
+static void ProfileSaverStop(ProfileSaver *saver) {
+	{
+		std::lock_guard<std::mutex> guard(saver->lock);
+		saver->quit = true;
+	}
+	saver->wake.notify_one();
+	if (saver->worker.joinable()) {
+		saver->worker.join();
+	}
+}
+
+#endif // PROFILE_H
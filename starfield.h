@@ -0,0 +1,119 @@
+#ifndef STARFIELD_H
+#define STARFIELD_H
+
+// Parallax star background.
+//
+// Each layer is generated once at startup into a small tileable texture with
+// repeat wrapping, then drawn every frame as a single quad whose source
+// rectangle scrolls. The per-frame cost is one textured quad per layer, no
+// matter how many stars a layer holds. Only plain textured quads are used, so
+// every raylib backend (software renderer included) draws it the same way.
+
+#include <stdint.h>
+#include <math.h>
+#include "raylib.h"
+
+#define STARFIELD_LAYERS 3
+#define STARFIELD_TILE_SIZE 512		// power of two so repeat wrap works everywhere
+#define STARFIELD_SEED 0x5EEDu
+
+typedef struct {
+	int starCount;			// per tile
+	int maxSize;			// pixels
+	unsigned char brightness;
+	float speed;			// pixels per second
+} StarLayerConfig;
+
+// Far to near: many dim specks drifting slowly, a few bright ones moving fast
+static const StarLayerConfig starLayerConfigs[STARFIELD_LAYERS] = {
+	{ 600, 1, 110, 15.0f },
+	{ 200, 2, 180, 40.0f },
+	{ 50, 3, 255, 90.0f },
+};
+
+typedef struct {
+	Texture2D textures[STARFIELD_LAYERS];
+	float offsets[STARFIELD_LAYERS];
+	bool loaded;
+} Starfield;
+
+// Own generator so building the background never disturbs GetRandomValue(),
+// which the benchmark relies on being seeded and repeatable.
+static uint32_t StarfieldRandom(uint32_t *state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+// Stars that cross an edge wrap to the opposite one, which keeps the tile seamless.
+static void PlotStar(Image *image, int x, int y, int size, unsigned char brightness) {
+	Color *pixels = (Color *)image->data;
+	for (int dy = 0; dy < size; dy++) {
+		for (int dx = 0; dx < size; dx++) {
+			// Larger stars get a softer outer ring
+			bool edge = (size > 2) && (dx == 0 || dy == 0 || dx == size - 1 || dy == size - 1);
+			unsigned char alpha = edge ? brightness/3 : brightness;
+			int px = (x + dx) % image->width;
+			int py = (y + dy) % image->height;
+			Color *pixel = &pixels[py * image->width + px];
+			if (alpha > pixel->a) {
+				*pixel = (Color){ 255, 255, 255, alpha };
+			}
+		}
+	}
+}
+
+static Image GenerateStarLayer(const StarLayerConfig *config, uint32_t seed) {
+	Image image = GenImageColor(STARFIELD_TILE_SIZE, STARFIELD_TILE_SIZE, BLANK);
+	uint32_t state = seed ? seed : 1;
+	for (int i = 0; i < config->starCount; i++) {
+		int x = StarfieldRandom(&state) % STARFIELD_TILE_SIZE;
+		int y = StarfieldRandom(&state) % STARFIELD_TILE_SIZE;
+		int size = 1 + StarfieldRandom(&state) % config->maxSize;
+		unsigned char brightness = config->brightness - StarfieldRandom(&state) % (config->brightness/2 + 1);
+		PlotStar(&image, x, y, size, brightness);
+	}
+	return image;
+}
+
+// Needs a window (GL context).
+static void LoadStarfield(Starfield *starfield, uint32_t seed) {
+	for (int i = 0; i < STARFIELD_LAYERS; i++) {
+		Image layer = GenerateStarLayer(&starLayerConfigs[i], seed * 2654435761u + i);
+		starfield->textures[i] = LoadTextureFromImage(layer);
+		SetTextureWrap(starfield->textures[i], TEXTURE_WRAP_REPEAT);
+		UnloadImage(layer);
+		starfield->offsets[i] = 0.0f;
+	}
+	starfield->loaded = true;
+}
+
+static void UnloadStarfield(Starfield *starfield) {
+	if (!starfield->loaded) {
+		return;
+	}
+	for (int i = 0; i < STARFIELD_LAYERS; i++) {
+		UnloadTexture(starfield->textures[i]);
+	}
+	starfield->loaded = false;
+}
+
+static void UpdateStarfield(Starfield *starfield, float dt) {
+	for (int i = 0; i < STARFIELD_LAYERS; i++) {
+		starfield->offsets[i] = fmodf(starfield->offsets[i] + starLayerConfigs[i].speed * dt, STARFIELD_TILE_SIZE);
+	}
+}
+
+// One quad per layer; the repeat wrap tiles it across the whole screen.
+static void DrawStarfield(const Starfield *starfield, int width, int height) {
+	if (!starfield->loaded) {
+		return;
+	}
+	for (int i = 0; i < STARFIELD_LAYERS; i++) {
+		Rectangle source = { 0.0f, -starfield->offsets[i], (float)width, (float)height };
+		DrawTextureRec(starfield->textures[i], source, (Vector2){ 0.0f, 0.0f }, WHITE);
+	}
+}
+
+#endif // STARFIELD_H
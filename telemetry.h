@@ -0,0 +1,159 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+// Session telemetry: fixed-size binary records appended to a memory-mapped ring
+// file. Writing a record is a handful of stores into the mapping - no syscalls,
+// no allocation - so it is safe to call from the frame loop. The file survives
+// across launches and is read back by telemetry_analyzer.
+//
+// Only one process writes the ring at a time. Windows gets this from the
+// FILE_SHARE_READ open in MapFileReadWrite(); elsewhere TelemetryOpen() takes
+// an exclusive flock, and a second running game leaves its writer disabled.
+
+#include "file_map.h"
+
+#if !defined(_WIN32)
+	#include <sys/file.h>
+#endif
+
+#define TELEMETRY_MAGIC 0x4D4C4554u // "TELM"
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_CAPACITY 65536    // records in the ring, must be a power of two (~18 min of frames)
+#define TELEMETRY_FILE "telemetry.bin"
+
+typedef enum {
+	TELEMETRY_SESSION_START,	// source: GameMode
+	TELEMETRY_SESSION_END,		// source: GameMode, value: session seconds, arg0: score, arg1: level
+	TELEMETRY_FRAME,			// value: frame time in ms, arg0: score, arg1: level
+	TELEMETRY_SHOT,				// arg0: bullets fired
+	TELEMETRY_HIT,				// source: EnemyType hit, arg0: 1 if the hit killed it
+	TELEMETRY_DAMAGE,			// source: EnemyType that dealt it, arg0: TelemetryDamageKind
+	TELEMETRY_BOMB,				// arg0: enemies caught in the radius, arg1: enemies killed
+	TELEMETRY_BOSS_SPAWN,		// arg0: level, arg1: boss max health
+	TELEMETRY_BOSS_KILL,		// value: seconds since the boss spawned, arg0: level
+	TELEMETRY_DIRECTOR,			// source: boss volley size, value: spawn density, arg0/arg1: smoothed sim/draw cost in us
+	TELEMETRY_INPUT_LATENCY,	// source: 1 in low-latency pacing, value: input-to-present ms, arg0: key
+	TELEMETRY_EVENT_COUNT
+} TelemetryEventType;
+
+typedef enum {
+	TELEMETRY_DAMAGE_BULLET,
+	TELEMETRY_DAMAGE_COLLISION
+} TelemetryDamageKind;
+
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t recordSize;
+	uint32_t capacity;
+	uint32_t sessionCounter;	// last session id handed out
+	uint64_t head;				// records ever written; the newest is at (head - 1) % capacity
+	uint8_t reserved[40];
+} TelemetryHeader;
+
+typedef struct {
+	uint32_t session;
+	uint16_t type;
+	uint16_t source;
+	float time;					// seconds since the session started
+	float value;
+	int32_t arg0;
+	int32_t arg1;
+} TelemetryRecord;
+
+static_assert(sizeof(TelemetryHeader) == 64, "telemetry header layout changed");
+static_assert(sizeof(TelemetryRecord) == 24, "telemetry record layout changed");
+
+typedef struct {
+	MappedFile file;
+	TelemetryHeader *header;
+	TelemetryRecord *records;
+	uint32_t session;
+	double sessionStart;
+	double now;
+} TelemetryWriter;
+
+static inline size_t TelemetryFileSize(uint32_t capacity) {
+	return sizeof(TelemetryHeader) + (size_t)capacity * sizeof(TelemetryRecord);
+}
+
+// Maps the ring file, keeping previous sessions if the file is compatible.
+// On failure (including another process already writing the file) the writer
+// stays disabled and every call below is a no-op.
+static inline bool TelemetryOpen(TelemetryWriter *writer, const char *path) {
+	memset(writer, 0, sizeof(*writer));
+	if (!MapFileReadWrite(&writer->file, path, TelemetryFileSize(TELEMETRY_CAPACITY))) {
+		return false;
+	}
+#if !defined(_WIN32)
+	// Released when UnmapFile() closes the descriptor
+	if (flock(writer->file.fd, LOCK_EX | LOCK_NB) != 0) {
+		UnmapFile(&writer->file);
+		return false;
+	}
+#endif
+	
+	TelemetryHeader *header = (TelemetryHeader *)writer->file.data;
+	if (header->magic != TELEMETRY_MAGIC || header->version != TELEMETRY_VERSION ||
+		header->recordSize != sizeof(TelemetryRecord) || header->capacity != TELEMETRY_CAPACITY) {
+		memset(header, 0, sizeof(*header));
+		header->magic = TELEMETRY_MAGIC;
+		header->version = TELEMETRY_VERSION;
+		header->recordSize = sizeof(TelemetryRecord);
+		header->capacity = TELEMETRY_CAPACITY;
+	}
+	
+	writer->header = header;
+	writer->records = (TelemetryRecord *)(header + 1);
+	return true;
+}
+
+static inline void TelemetryClose(TelemetryWriter *writer) {
+	FlushMappedFile(&writer->file);
+	UnmapFile(&writer->file);
+	memset(writer, 0, sizeof(*writer));
+}
+
+// Latches the timestamp used by every record written until the next call.
+static inline void TelemetryBeginFrame(TelemetryWriter *writer, double now) {
+	writer->now = now;
+}
+
+static inline void TelemetryWrite(TelemetryWriter *writer, TelemetryEventType type, int source, float value, int arg0, int arg1) {
+	if (!writer->header || !writer->session) {
+		return;
+	}
+	
+	uint64_t head = writer->header->head;
+	TelemetryRecord *record = &writer->records[head & (TELEMETRY_CAPACITY - 1)];
+	record->session = writer->session;
+	record->type = (uint16_t)type;
+	record->source = (uint16_t)source;
+	record->time = (float)(writer->now - writer->sessionStart);
+	record->value = value;
+	record->arg0 = arg0;
+	record->arg1 = arg1;
+	writer->header->head = head + 1;
+}
+
+static inline void TelemetryBeginSession(TelemetryWriter *writer, int gameMode) {
+	if (!writer->header) {
+		return;
+	}
+	writer->session = ++writer->header->sessionCounter;
+	writer->sessionStart = writer->now;
+	TelemetryWrite(writer, TELEMETRY_SESSION_START, gameMode, 0.0f, 0, 0);
+}
+
+// Closes the session and lets the OS start flushing pages (the only syscall,
+// once per game).
+static inline void TelemetryEndSession(TelemetryWriter *writer, int gameMode, int score, int level) {
+	if (!writer->session) {
+		return;
+	}
+	TelemetryWrite(writer, TELEMETRY_SESSION_END, gameMode, (float)(writer->now - writer->sessionStart), score, level);
+	writer->session = 0;
+	FlushMappedFile(&writer->file);
+}
+
+#endif // TELEMETRY_H
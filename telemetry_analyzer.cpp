@@ -0,0 +1,313 @@
+// Offline reader for the telemetry ring written by the game.
+//
+//   g++ -O2 -std=c++20 telemetry_analyzer.cpp -o telemetry_analyzer
+//   telemetry_analyzer [telemetry.bin] [--last]
+//
+// Prints one line per session (accuracy, damage taken, boss kills), then
+// aggregate damage-by-source, boss time-to-kill and frame-time percentile
+// tables over every session still in the ring (or only the newest with --last).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "telemetry.h"
+
+#define SOURCE_COUNT 3 // NORMAL_ENEMY, ELITE_ENEMY, BOSS_ENEMY
+
+static const char *sourceNames[SOURCE_COUNT] = { "Normal", "Elite", "Boss" };
+static const char *modeNames[2] = { "Timed", "Infinite" };
+
+typedef struct {
+	uint32_t id;
+	int mode;
+	bool ended;
+	float length;
+	int score;
+	int level;
+	int shots;
+	int hits;
+	int kills;
+	int bombs;
+	int damage[SOURCE_COUNT][2];	// [source][TelemetryDamageKind]
+	int bossKills;
+	int frames;
+	int directorChanges;
+	float minDensity;
+} SessionStats;
+
+typedef struct {
+	float *values;
+	int count;
+	int capacity;
+} FloatList;
+
+static void PushFloat(FloatList *list, float value) {
+	if (list->count == list->capacity) {
+		list->capacity = list->capacity ? list->capacity*2 : 1024;
+		list->values = (float *)realloc(list->values, list->capacity*sizeof(float));
+	}
+	list->values[list->count++] = value;
+}
+
+static int CompareFloat(const void *a, const void *b) {
+	float x = *(const float *)a;
+	float y = *(const float *)b;
+	return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile on a sorted list.
+static float Percentile(const FloatList *list, float p) {
+	if (list->count == 0) {
+		return 0.0f;
+	}
+	int rank = (int)(p/100.0f*list->count + 0.5f);
+	if (rank < 1) {
+		rank = 1;
+	}
+	if (rank > list->count) {
+		rank = list->count;
+	}
+	return list->values[rank - 1];
+}
+
+static void PrintPercentiles(const char *label, FloatList *list, const char *unit) {
+	if (list->count == 0) {
+		printf("  %-15s (no samples)\n", label);
+		return;
+	}
+	qsort(list->values, list->count, sizeof(float), CompareFloat);
+	double sum = 0.0;
+	for (int i = 0; i < list->count; i++) {
+		sum += list->values[i];
+	}
+	printf("  %-15s n=%-7d mean %7.2f  p50 %7.2f  p90 %7.2f  p99 %7.2f  p99.9 %7.2f  max %7.2f %s\n",
+		   label, list->count, sum/list->count,
+		   Percentile(list, 50.0f), Percentile(list, 90.0f), Percentile(list, 99.0f),
+		   Percentile(list, 99.9f), list->values[list->count - 1], unit);
+}
+
+static void PrintFrameHistogram(const FloatList *frames) {
+	static const float edges[] = { 4.0f, 8.0f, 12.0f, 16.7f, 20.0f, 33.3f, 50.0f };
+	const int bucketCount = sizeof(edges)/sizeof(edges[0]) + 1;
+	int buckets[sizeof(edges)/sizeof(edges[0]) + 1] = {0};
+	
+	for (int i = 0; i < frames->count; i++) {
+		int b = 0;
+		while (b < bucketCount - 1 && frames->values[i] >= edges[b]) {
+			b++;
+		}
+		buckets[b]++;
+	}
+	
+	printf("\nFrame time histogram:\n");
+	for (int b = 0; b < bucketCount; b++) {
+		char range[32];
+		if (b == 0) {
+			snprintf(range, sizeof(range), "< %.1f ms", edges[0]);
+		} else if (b == bucketCount - 1) {
+			snprintf(range, sizeof(range), ">= %.1f ms", edges[b - 1]);
+		} else {
+			snprintf(range, sizeof(range), "%.1f-%.1f ms", edges[b - 1], edges[b]);
+		}
+		
+		float share = frames->count ? (float)buckets[b]/frames->count : 0.0f;
+		char bar[51] = {0};
+		int width = (int)(share*50.0f + 0.5f);
+		memset(bar, '#', width);
+		printf("  %-14s %8d  %6.2f%%  %s\n", range, buckets[b], share*100.0f, bar);
+	}
+}
+
+int main(int argc, char **argv) {
+	const char *path = TELEMETRY_FILE;
+	bool lastOnly = false;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--last") == 0) {
+			lastOnly = true;
+		} else {
+			path = argv[i];
+		}
+	}
+	
+	MappedFile file;
+	if (!MapFileRead(&file, path)) {
+		fprintf(stderr, "cannot open %s\n", path);
+		return 1;
+	}
+	
+	const TelemetryHeader *header = (const TelemetryHeader *)file.data;
+	if (file.size < sizeof(TelemetryHeader) || header->magic != TELEMETRY_MAGIC ||
+		header->version != TELEMETRY_VERSION || header->recordSize != sizeof(TelemetryRecord) ||
+		file.size < TelemetryFileSize(header->capacity)) {
+		fprintf(stderr, "%s is not a version %d telemetry file\n", path, TELEMETRY_VERSION);
+		UnmapFile(&file);
+		return 1;
+	}
+	
+	const TelemetryRecord *records = (const TelemetryRecord *)(header + 1);
+	uint64_t head = header->head;
+	uint64_t first = head > header->capacity ? head - header->capacity : 0;
+	
+	printf("Telemetry: %s\n", path);
+	printf("  %llu records in ring of %u (%llu overwritten)\n\n",
+		   (unsigned long long)(head - first), header->capacity, (unsigned long long)first);
+	
+	// Indexed by session id. Records of different sessions can interleave (a
+	// crashed writer, or an old build that did not lock the file), so sessions
+	// are looked up by id rather than split where the id changes. The counter is
+	// read once because a running game may bump it while we walk.
+	uint32_t sessionCounter = header->sessionCounter;
+	int sessionCount = 0;
+	SessionStats *sessions = (SessionStats *)calloc(sessionCounter + 1, sizeof(SessionStats));
+	uint32_t lastSession = 0;
+	for (uint64_t i = first; i < head; i++) {
+		const TelemetryRecord *r = &records[i % header->capacity];
+		if (r->session > lastSession) {
+			lastSession = r->session;
+		}
+	}
+	
+	FloatList frameTimes = {0};
+	FloatList bossTtk = {0};
+	FloatList inputLatency[2] = {{0}};	// classic, low-latency pacing
+	int damageTotals[SOURCE_COUNT][2] = {{0}};
+	SessionStats *current = NULL;
+	int directorChanges = 0;
+	
+	for (uint64_t i = first; i < head; i++) {
+		const TelemetryRecord *r = &records[i % header->capacity];
+		if (r->session == 0 || r->session > sessionCounter) {
+			continue;
+		}
+		if (lastOnly && r->session != lastSession) {
+			continue;
+		}
+		
+		current = &sessions[r->session];
+		if (current->id == 0) {
+			current->id = r->session;
+			current->minDensity = 1.0f;
+			sessionCount++;
+		}
+		
+		switch (r->type) {
+		case TELEMETRY_SESSION_START:
+			current->mode = r->source;
+			break;
+		case TELEMETRY_SESSION_END:
+			current->ended = true;
+			current->length = r->value;
+			current->score = r->arg0;
+			current->level = r->arg1;
+			break;
+		case TELEMETRY_FRAME:
+			current->frames++;
+			current->length = r->time;
+			current->score = r->arg0;
+			current->level = r->arg1;
+			PushFloat(&frameTimes, r->value);
+			break;
+		case TELEMETRY_SHOT:
+			current->shots += r->arg0;
+			break;
+		case TELEMETRY_HIT:
+			current->hits++;
+			current->kills += r->arg0;
+			break;
+		case TELEMETRY_DAMAGE:
+			if (r->source < SOURCE_COUNT && r->arg0 >= 0 && r->arg0 < 2) {
+				current->damage[r->source][r->arg0] += (int)r->value;
+				damageTotals[r->source][r->arg0] += (int)r->value;
+			}
+			break;
+		case TELEMETRY_BOMB:
+			current->bombs++;
+			current->kills += r->arg1;
+			break;
+		case TELEMETRY_BOSS_KILL:
+			current->bossKills++;
+			PushFloat(&bossTtk, r->value);
+			break;
+		case TELEMETRY_INPUT_LATENCY:
+			PushFloat(&inputLatency[r->source & 1], r->value);
+			break;
+		case TELEMETRY_DIRECTOR:
+			current->directorChanges++;
+			if (r->value < current->minDensity) {
+				current->minDensity = r->value;
+			}
+			directorChanges++;
+			break;
+		default:
+			break;
+		}
+	}
+	
+	printf("Session  Mode      Length   Score  Level  Shots   Hits  Accuracy  Kills  Bombs  Dmg taken  Bosses\n");
+	int totalShots = 0;
+	int totalHits = 0;
+	for (uint32_t s = 1; s <= sessionCounter; s++) {
+		const SessionStats *st = &sessions[s];
+		if (st->id == 0) {
+			continue;
+		}
+		int damage = 0;
+		for (int src = 0; src < SOURCE_COUNT; src++) {
+			damage += st->damage[src][0] + st->damage[src][1];
+		}
+		totalShots += st->shots;
+		totalHits += st->hits;
+		printf("%7u  %-8s %6.1fs%s %6d  %5d  %5d  %5d  %7.1f%%  %5d  %5d  %9d  %6d\n",
+			   st->id, modeNames[st->mode & 1], st->length, st->ended ? " " : "*",
+			   st->score, st->level, st->shots, st->hits,
+			   st->shots ? 100.0f*st->hits/st->shots : 0.0f,
+			   st->kills, st->bombs, damage, st->bossKills);
+	}
+	if (sessionCount == 0) {
+		printf("  (no sessions)\n");
+	}
+	printf("  * session did not end cleanly (crash or still running)\n");
+	printf("  overall accuracy: %.1f%% (%d/%d)\n", totalShots ? 100.0f*totalHits/totalShots : 0.0f, totalHits, totalShots);
+	
+	printf("\nDamage taken by source:\n");
+	printf("  %-8s %8s %10s\n", "Source", "Bullets", "Collisions");
+	for (int src = 0; src < SOURCE_COUNT; src++) {
+		printf("  %-8s %8d %10d\n", sourceNames[src], damageTotals[src][TELEMETRY_DAMAGE_BULLET], damageTotals[src][TELEMETRY_DAMAGE_COLLISION]);
+	}
+	
+	printf("\nPercentiles:\n");
+	PrintPercentiles("Boss TTK", &bossTtk, "s");
+	PrintPercentiles("Frame time", &frameTimes, "ms");
+	PrintPercentiles("Input (classic)", &inputLatency[0], "ms");
+	PrintPercentiles("Input (low lat)", &inputLatency[1], "ms");
+	PrintFrameHistogram(&frameTimes);
+	
+	// The most recent spawn director decisions, for tuning its thresholds.
+	printf("\nSpawn director: %d decisions\n", directorChanges);
+	for (uint32_t s = 1; s <= sessionCounter; s++) {
+		if (sessions[s].directorChanges > 0) {
+			printf("  session %u: %d changes, lowest density %.2f\n", sessions[s].id, sessions[s].directorChanges, sessions[s].minDensity);
+		}
+	}
+	int skip = directorChanges - 20;
+	for (uint64_t i = first; i < head; i++) {
+		const TelemetryRecord *r = &records[i % header->capacity];
+		if (r->type != TELEMETRY_DIRECTOR || r->session == 0 || (lastOnly && r->session != lastSession)) {
+			continue;
+		}
+		if (skip-- > 0) {
+			continue;
+		}
+		printf("  [%u @ %7.1fs] sim %6.2f ms + draw %6.2f ms -> density %.2f, boss volley %d\n",
+			   r->session, r->time, r->arg0/1000.0f, r->arg1/1000.0f, r->value, r->source);
+	}
+	
+	free(frameTimes.values);
+	free(bossTtk.values);
+	free(inputLatency[0].values);
+	free(inputLatency[1].values);
+	free(sessions);
+	UnmapFile(&file);
+	return 0;
+}